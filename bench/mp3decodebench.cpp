@@ -0,0 +1,108 @@
+// Measures MP3 decode throughput (MB of MP3 input per second) of AudioFileDecoder.
+//
+// Usage: vud_mp3_bench [--iterations N] <file.mp3 | directory>...
+//
+// Directories are scanned recursively for *.mp3. Build both vud_mp3_bench and
+// vud_mp3_bench_scalar and run them on the same corpus to compare the SIMD
+// and scalar minimp3 paths.
+
+#include "audio/audiobuffer.h"
+#include "audio/audiofiledecoder.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTextStream>
+
+namespace {
+
+QStringList collectCorpus(const QStringList &arguments)
+{
+    QStringList files;
+    for (const QString &argument : arguments) {
+        const QFileInfo info(argument);
+        if (info.isDir()) {
+            QDirIterator it(info.absoluteFilePath(), QStringList() << QStringLiteral("*.mp3"),
+                            QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext())
+                files << it.next();
+        } else if (info.isFile()) {
+            files << info.absoluteFilePath();
+        }
+    }
+    files.sort();
+    return files;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("MP3 decode throughput benchmark"));
+    parser.addHelpOption();
+    QCommandLineOption iterationsOption(QStringList() << QStringLiteral("n") << QStringLiteral("iterations"),
+                                        QStringLiteral("Decode every file <count> times."),
+                                        QStringLiteral("count"), QStringLiteral("3"));
+    parser.addOption(iterationsOption);
+    parser.addPositionalArgument(QStringLiteral("corpus"), QStringLiteral("MP3 files or directories."));
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const QStringList corpus = collectCorpus(parser.positionalArguments());
+    if (corpus.isEmpty()) {
+        out << "No MP3 files given" << Qt::endl;
+        return 1;
+    }
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+
+    out << "backend: " << AudioFileDecoder::mp3Backend() << ", iterations: " << iterations << Qt::endl;
+
+    AudioFileDecoder decoder;
+    qint64 totalInputBytes = 0;
+    qint64 totalAudioMs = 0;
+    qint64 totalNs = 0;
+    for (const QString &path : corpus) {
+        const qint64 inputBytes = QFileInfo(path).size();
+        qint64 bestNs = -1;
+        qint64 audioMs = 0;
+        for (int i = 0; i < iterations; ++i) {
+            AudioBuffer buffer;
+            QString error;
+            QElapsedTimer timer;
+            timer.start();
+            if (!decoder.decodeFile(path, buffer, &error)) {
+                out << "FAILED " << path << ": " << error << Qt::endl;
+                bestNs = -1;
+                break;
+            }
+            const qint64 ns = timer.nsecsElapsed();
+            if (bestNs < 0 || ns < bestNs)
+                bestNs = ns;
+            audioMs = buffer.durationMs();
+        }
+        if (bestNs <= 0)
+            continue;
+
+        const double seconds = bestNs / 1e9;
+        out << QString::asprintf("%8.2f MB/s %8.1fx realtime  ", inputBytes / 1e6 / seconds, audioMs / 1000.0 / seconds)
+            << QFileInfo(path).fileName() << Qt::endl;
+        totalInputBytes += inputBytes;
+        totalAudioMs += audioMs;
+        totalNs += bestNs;
+    }
+
+    if (totalNs > 0) {
+        const double seconds = totalNs / 1e9;
+        out << QString::asprintf("total: %.2f MB in %.3f s, %.2f MB/s, %.1fx realtime",
+                                 totalInputBytes / 1e6, seconds, totalInputBytes / 1e6 / seconds,
+                                 totalAudioMs / 1000.0 / seconds)
+            << Qt::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Measures VolumeAnalyzer throughput (analysis windows per second) for every
+// RMS/peak kernel the CPU supports, on synthetic 16-bit PCM.
+//
+// Usage: vud_volume_bench [--seconds S] [--channels C] [--window MS] [--iterations N]
+
+#include "audio/audiobuffer.h"
+#include "audio/volumeanalyzer.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+namespace {
+
+AudioBuffer makeNoise(int seconds, int channels)
+{
+    QAudioFormat format;
+    format.setSampleRate(44100);
+    format.setChannelCount(channels);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec(QStringLiteral("audio/pcm"));
+
+    AudioBuffer buffer;
+    buffer.setFormat(format);
+    QByteArray data(seconds * format.sampleRate() * channels * 2, Qt::Uninitialized);
+    QRandomGenerator generator(42);
+    generator.fillRange(reinterpret_cast<quint32 *>(data.data()), data.size() / 4);
+    buffer.append(data);
+    return buffer;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Volume analysis kernel benchmark"));
+    parser.addHelpOption();
+    QCommandLineOption secondsOption(QStringLiteral("seconds"), QStringLiteral("Length of the test signal."),
+                                     QStringLiteral("seconds"), QStringLiteral("600"));
+    QCommandLineOption channelsOption(QStringLiteral("channels"), QStringLiteral("Channel count (1 or 2 use SIMD)."),
+                                      QStringLiteral("count"), QStringLiteral("2"));
+    QCommandLineOption windowOption(QStringLiteral("window"), QStringLiteral("Analysis window in milliseconds."),
+                                    QStringLiteral("ms"), QStringLiteral("100"));
+    QCommandLineOption iterationsOption(QStringList() << QStringLiteral("n") << QStringLiteral("iterations"),
+                                        QStringLiteral("Analyze the signal <count> times per kernel."),
+                                        QStringLiteral("count"), QStringLiteral("5"));
+    parser.addOption(secondsOption);
+    parser.addOption(channelsOption);
+    parser.addOption(windowOption);
+    parser.addOption(iterationsOption);
+    parser.process(app);
+
+    const int seconds = qMax(1, parser.value(secondsOption).toInt());
+    const int channels = qBound(1, parser.value(channelsOption).toInt(), 8);
+    const int windowMs = qMax(1, parser.value(windowOption).toInt());
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+
+    QTextStream out(stdout);
+    const AudioBuffer buffer = makeNoise(seconds, channels);
+    out << "signal: " << seconds << " s, " << channels << " ch, window " << windowMs << " ms" << Qt::endl;
+
+    const VolumeAnalyzer::Kernel kernels[] = {VolumeAnalyzer::Kernel::Scalar, VolumeAnalyzer::Kernel::Sse2,
+                                              VolumeAnalyzer::Kernel::Avx2};
+    QStringList measured;
+    for (VolumeAnalyzer::Kernel kernel : kernels) {
+        VolumeAnalyzer::setKernel(kernel);
+        const QString name = VolumeAnalyzer::kernelName();
+        if (measured.contains(name))
+            continue; // not supported here, resolved to a kernel already measured
+        measured << name;
+
+        qint64 bestNs = -1;
+        int windows = 0;
+        for (int i = 0; i < iterations; ++i) {
+            QElapsedTimer timer;
+            timer.start();
+            windows = VolumeAnalyzer::analyzeVolume(buffer, windowMs).size();
+            const qint64 ns = timer.nsecsElapsed();
+            if (bestNs < 0 || ns < bestNs)
+                bestNs = ns;
+        }
+        const double elapsed = qMax<qint64>(1, bestNs) / 1e9;
+        out << QString::asprintf("%-7s %12.0f windows/s %8.1fx realtime",
+                                 qPrintable(name), windows / elapsed, seconds / elapsed)
+            << Qt::endl;
+    }
+    VolumeAnalyzer::setKernel(VolumeAnalyzer::Kernel::Auto);
+    return 0;
+}
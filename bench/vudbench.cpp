@@ -0,0 +1,457 @@
+// Micro-benchmark suite for the audio core, modelled on Google Benchmark: every
+// benchmark repeats its body until --min-time has passed and reports the mean
+// wall and CPU time per iteration. Signal-based benchmarks run on synthetic
+// 44.1 kHz stereo PCM of each --minutes length; MP3 decode runs on the files
+// passed with --mp3. --format json writes Google Benchmark compatible JSON so
+// results can be compared between releases with the usual tooling.
+//
+// Usage: vud_bench [--minutes 1,10,60] [--filter REGEX] [--min-time S]
+//                  [--format console|json] [--out FILE] [--mp3 FILE]...
+
+#include "audio/audiobuffer.h"
+#include "audio/audiofiledecoder.h"
+#include "audio/audioproject.h"
+#include "audio/glueengine.h"
+#include "audio/volumeanalyzer.h"
+#include "audio/wavutils.h"
+#include "utils/pathutils.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+
+#include <ctime>
+#include <functional>
+#include <memory>
+
+namespace {
+
+// Iteration driver handed to every benchmark body:
+//     while (state.keepRunning()) { ...measured work... }
+class BenchState
+{
+public:
+    explicit BenchState(double minTimeSeconds)
+        : m_minTimeNs(static_cast<qint64>(minTimeSeconds * 1e9))
+    {
+    }
+
+    bool keepRunning()
+    {
+        if (!m_started) {
+            m_started = true;
+            m_cpuStart = std::clock();
+            m_timer.start();
+            return true;
+        }
+        ++m_iterations;
+        if (m_failed || m_timer.nsecsElapsed() < m_minTimeNs)
+            return !m_failed;
+        m_realNs = m_timer.nsecsElapsed();
+        m_cpuNs = static_cast<qint64>((std::clock() - m_cpuStart) * (1e9 / CLOCKS_PER_SEC));
+        return false;
+    }
+
+    // Bytes of input one iteration processes, reported as bytes_per_second
+    void setBytesPerIteration(qint64 bytes) { m_bytesPerIteration = bytes; }
+    void fail(const QString &message)
+    {
+        m_failed = true;
+        m_error = message;
+    }
+
+    bool failed() const { return m_failed; }
+    const QString &error() const { return m_error; }
+    qint64 iterations() const { return m_iterations; }
+    double realMsPerIteration() const { return m_iterations > 0 ? m_realNs / 1e6 / m_iterations : 0.0; }
+    double cpuMsPerIteration() const { return m_iterations > 0 ? m_cpuNs / 1e6 / m_iterations : 0.0; }
+    double bytesPerSecond() const
+    {
+        return m_realNs > 0 ? m_bytesPerIteration * static_cast<double>(m_iterations) * 1e9 / m_realNs : 0.0;
+    }
+
+private:
+    qint64 m_minTimeNs = 0;
+    bool m_started = false;
+    bool m_failed = false;
+    QString m_error;
+    QElapsedTimer m_timer;
+    std::clock_t m_cpuStart = 0;
+    qint64 m_iterations = 0;
+    qint64 m_realNs = 0;
+    qint64 m_cpuNs = 0;
+    qint64 m_bytesPerIteration = 0;
+};
+
+QAudioFormat benchFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(44100);
+    format.setChannelCount(2);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec(QStringLiteral("audio/pcm"));
+    return format;
+}
+
+// Synthetic signal of one length plus files derived from it, created lazily so
+// a --filter that skips the file benchmarks does not pay for writing them
+class Fixture
+{
+public:
+    explicit Fixture(int minutes)
+        : m_minutes(minutes)
+    {
+        m_pcm.resize(minutes * 60 * 44100 * 2 * 2);
+        QRandomGenerator generator(42);
+        generator.fillRange(reinterpret_cast<quint32 *>(m_pcm.data()), m_pcm.size() / 4);
+        // Paged like a decoded track, not adopted as a single page
+        m_buffer.setFormat(benchFormat());
+        m_buffer.append(m_pcm);
+    }
+
+    int minutes() const { return m_minutes; }
+    const QByteArray &pcm() const { return m_pcm; }
+    const AudioBuffer &buffer() const { return m_buffer; }
+    QString path(const QString &fileName) const { return m_dir.filePath(fileName); }
+
+    const QString &wavFile(QString *errorString)
+    {
+        if (m_wavFile.isEmpty()) {
+            const QString filePath = path(QStringLiteral("signal.wav"));
+            if (WavUtils::writeWavFile(filePath, m_buffer.format(), m_pcm, errorString))
+                m_wavFile = filePath;
+        }
+        return m_wavFile;
+    }
+
+    // One recording per default-length segment, as the app leaves them after recording
+    const QVector<SegmentInfo> &recordedSegments(QString *errorString)
+    {
+        if (m_segments.isEmpty()) {
+            QVector<SegmentInfo> segments = AudioProject::computeSegments(m_buffer, 5);
+            const QString cutsDir = PathUtils::ensureDirectory(path(QStringLiteral("cut")));
+            for (SegmentInfo &segment : segments) {
+                segment.recordingPath = PathUtils::composeSegmentFile(cutsDir, segment.displayIndex);
+                segment.hasRecording = true;
+                if (!WavUtils::writeWavFile(segment.recordingPath,
+                                            m_buffer.view(segment.startFrame, segment.frameCount), errorString))
+                    return m_segments;
+            }
+            m_segments = segments;
+        }
+        return m_segments;
+    }
+
+private:
+    int m_minutes = 0;
+    QByteArray m_pcm;
+    AudioBuffer m_buffer;
+    QTemporaryDir m_dir;
+    QString m_wavFile;
+    QVector<SegmentInfo> m_segments;
+};
+
+using SignalBenchmark = std::function<void(BenchState &, Fixture &)>;
+
+struct RegisteredBenchmark
+{
+    QString name;
+    SignalBenchmark run;
+};
+
+QVector<RegisteredBenchmark> signalBenchmarks()
+{
+    QVector<RegisteredBenchmark> benchmarks;
+
+    benchmarks.append({QStringLiteral("BM_ReverseSamples"), [](BenchState &state, Fixture &fixture) {
+        const AudioBuffer &buffer = fixture.buffer();
+        state.setBytesPerIteration(buffer.byteCount());
+        while (state.keepRunning()) {
+            const QByteArray reversed = AudioBuffer::reverseSamples(fixture.pcm(), buffer.format());
+            Q_UNUSED(reversed);
+        }
+    }});
+
+    // Slices every default-length segment once, like splitting and previewing does
+    benchmarks.append({QStringLiteral("BM_SliceFrames"), [](BenchState &state, Fixture &fixture) {
+        const AudioBuffer &buffer = fixture.buffer();
+        const QVector<SegmentInfo> segments = AudioProject::computeSegments(buffer, 5);
+        state.setBytesPerIteration(buffer.byteCount());
+        while (state.keepRunning()) {
+            for (const SegmentInfo &segment : segments) {
+                const QByteArray slice = buffer.sliceFrames(segment.startFrame, segment.frameCount);
+                Q_UNUSED(slice);
+            }
+        }
+    }});
+
+    // Same segments measured through views, without copying them first
+    benchmarks.append({QStringLiteral("BM_AnalyzeSegmentViews"), [](BenchState &state, Fixture &fixture) {
+        const AudioBuffer &buffer = fixture.buffer();
+        const QVector<SegmentInfo> segments = AudioProject::computeSegments(buffer, 5);
+        state.setBytesPerIteration(buffer.byteCount());
+        while (state.keepRunning()) {
+            for (const SegmentInfo &segment : segments) {
+                const VolumeProfile profile =
+                    VolumeAnalyzer::computeProfile(buffer.view(segment.startFrame, segment.frameCount), 100);
+                Q_UNUSED(profile);
+            }
+        }
+    }});
+
+    benchmarks.append({QStringLiteral("BM_AnalyzeVolume"), [](BenchState &state, Fixture &fixture) {
+        state.setBytesPerIteration(fixture.buffer().byteCount());
+        while (state.keepRunning()) {
+            const auto levels = VolumeAnalyzer::analyzeVolume(fixture.buffer(), 100);
+            Q_UNUSED(levels);
+        }
+    }});
+
+    benchmarks.append({QStringLiteral("BM_WriteWavFile"), [](BenchState &state, Fixture &fixture) {
+        const AudioBuffer &buffer = fixture.buffer();
+        const QString filePath = fixture.path(QStringLiteral("write.wav"));
+        state.setBytesPerIteration(buffer.byteCount());
+        QString error;
+        while (state.keepRunning()) {
+            if (!WavUtils::writeWavFile(filePath, buffer.format(), fixture.pcm(), &error))
+                state.fail(error);
+        }
+        QFile::remove(filePath);
+    }});
+
+    benchmarks.append({QStringLiteral("BM_ReadWavFile"), [](BenchState &state, Fixture &fixture) {
+        QString error;
+        const QString filePath = fixture.wavFile(&error);
+        if (filePath.isEmpty()) {
+            state.fail(error);
+            return;
+        }
+        state.setBytesPerIteration(fixture.buffer().byteCount());
+        while (state.keepRunning()) {
+            QByteArray pcm;
+            QAudioFormat format;
+            if (!WavUtils::readWavFile(filePath, pcm, format, &error))
+                state.fail(error);
+        }
+    }});
+
+    benchmarks.append({QStringLiteral("BM_SplitIntoSegments"), [](BenchState &state, Fixture &fixture) {
+        AudioProject project;
+        project.originalBuffer() = fixture.buffer();
+        while (state.keepRunning())
+            project.splitIntoSegments();
+    }});
+
+    // The same work AppController::glueSegments() does: trim, glue and reverse all recordings
+    benchmarks.append({QStringLiteral("BM_GlueSegments"), [](BenchState &state, Fixture &fixture) {
+        QString error;
+        const QVector<SegmentInfo> &segments = fixture.recordedSegments(&error);
+        if (segments.isEmpty()) {
+            state.fail(error);
+            return;
+        }
+        GlueEngine glue;
+        const QString songPath = fixture.path(QStringLiteral("song.wav"));
+        const QString reversePath = fixture.path(QStringLiteral("reverse.wav"));
+        state.setBytesPerIteration(fixture.buffer().byteCount());
+        while (state.keepRunning()) {
+            if (!glue.glue(segments, 0.1, songPath, reversePath, &error))
+                state.fail(error);
+        }
+        QFile::remove(songPath);
+        QFile::remove(reversePath);
+    }});
+
+    return benchmarks;
+}
+
+void runMp3Decode(BenchState &state, const QString &filePath)
+{
+    AudioFileDecoder decoder;
+    state.setBytesPerIteration(QFileInfo(filePath).size());
+    QString error;
+    while (state.keepRunning()) {
+        AudioBuffer buffer;
+        if (!decoder.decodeFile(filePath, buffer, &error))
+            state.fail(error);
+    }
+}
+
+struct BenchResult
+{
+    QString name;
+    BenchState state;
+};
+
+QJsonObject toJson(const BenchResult &result)
+{
+    QJsonObject object;
+    object[QStringLiteral("name")] = result.name;
+    object[QStringLiteral("run_name")] = result.name;
+    object[QStringLiteral("run_type")] = QStringLiteral("iteration");
+    if (result.state.failed()) {
+        object[QStringLiteral("error_occurred")] = true;
+        object[QStringLiteral("error_message")] = result.state.error();
+        return object;
+    }
+    object[QStringLiteral("iterations")] = result.state.iterations();
+    object[QStringLiteral("real_time")] = result.state.realMsPerIteration();
+    object[QStringLiteral("cpu_time")] = result.state.cpuMsPerIteration();
+    object[QStringLiteral("time_unit")] = QStringLiteral("ms");
+    if (result.state.bytesPerSecond() > 0.0)
+        object[QStringLiteral("bytes_per_second")] = result.state.bytesPerSecond();
+    return object;
+}
+
+QJsonObject context()
+{
+    QJsonObject object;
+    object[QStringLiteral("date")] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    object[QStringLiteral("host_name")] = QSysInfo::machineHostName();
+    object[QStringLiteral("executable")] = QCoreApplication::applicationFilePath();
+    object[QStringLiteral("num_cpus")] = QThread::idealThreadCount();
+    object[QStringLiteral("cpu_architecture")] = QSysInfo::currentCpuArchitecture();
+#ifdef NDEBUG
+    object[QStringLiteral("library_build_type")] = QStringLiteral("release");
+#else
+    object[QStringLiteral("library_build_type")] = QStringLiteral("debug");
+#endif
+    object[QStringLiteral("mp3_backend")] = AudioFileDecoder::mp3Backend();
+    object[QStringLiteral("volume_kernel")] = VolumeAnalyzer::kernelName();
+    return object;
+}
+
+void printConsole(QTextStream &out, const BenchResult &result)
+{
+    if (result.state.failed()) {
+        out << QString::asprintf("%-36s ERROR: ", qPrintable(result.name)) << result.state.error() << Qt::endl;
+        return;
+    }
+    out << QString::asprintf("%-36s %12.3f ms %12.3f ms %10lld", qPrintable(result.name),
+                             result.state.realMsPerIteration(), result.state.cpuMsPerIteration(),
+                             static_cast<long long>(result.state.iterations()));
+    if (result.state.bytesPerSecond() > 0.0)
+        out << QString::asprintf(" %10.1f MB/s", result.state.bytesPerSecond() / 1e6);
+    out << Qt::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Audio core micro-benchmarks"));
+    parser.addHelpOption();
+    QCommandLineOption minutesOption(QStringLiteral("minutes"), QStringLiteral("Comma separated signal lengths."),
+                                     QStringLiteral("list"), QStringLiteral("1,10,60"));
+    QCommandLineOption filterOption(QStringLiteral("filter"), QStringLiteral("Run only benchmarks matching <regex>."),
+                                    QStringLiteral("regex"));
+    QCommandLineOption minTimeOption(QStringLiteral("min-time"),
+                                     QStringLiteral("Minimum measuring time per benchmark in seconds."),
+                                     QStringLiteral("seconds"), QStringLiteral("0.5"));
+    QCommandLineOption formatOption(QStringLiteral("format"), QStringLiteral("Output format: console or json."),
+                                    QStringLiteral("format"), QStringLiteral("console"));
+    QCommandLineOption outOption(QStringLiteral("out"), QStringLiteral("Also write JSON results to <file>."),
+                                 QStringLiteral("file"));
+    QCommandLineOption mp3Option(QStringLiteral("mp3"), QStringLiteral("MP3 file for BM_Mp3Decode, repeatable."),
+                                 QStringLiteral("file"));
+    parser.addOption(minutesOption);
+    parser.addOption(filterOption);
+    parser.addOption(minTimeOption);
+    parser.addOption(formatOption);
+    parser.addOption(outOption);
+    parser.addOption(mp3Option);
+    parser.process(app);
+
+    // Keep the app's progress logging out of the measurements and the JSON on stdout
+    QLoggingCategory::setFilterRules(QStringLiteral("*.info=false\n*.debug=false"));
+
+    const QRegularExpression filter(parser.value(filterOption));
+    if (!filter.isValid()) {
+        QTextStream(stderr) << "Invalid --filter: " << filter.errorString() << Qt::endl;
+        return 2;
+    }
+    const double minTime = qMax(0.0, parser.value(minTimeOption).toDouble());
+    const bool json = parser.value(formatOption) == QStringLiteral("json");
+    QList<int> lengths;
+    for (const QString &item : parser.value(minutesOption).split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        // QByteArray sizes are int, which caps one signal at a bit over 2 GB
+        const int minutes = item.trimmed().toInt();
+        if (minutes > 0 && minutes <= 180)
+            lengths << minutes;
+    }
+
+    QTextStream out(stdout);
+    if (!json)
+        out << QString::asprintf("%-36s %15s %15s %10s", "Benchmark", "Time", "CPU", "Iterations") << Qt::endl;
+
+    QVector<BenchResult> results;
+    auto record = [&](BenchResult result) {
+        if (!json)
+            printConsole(out, result);
+        results.append(std::move(result));
+    };
+
+    const QVector<RegisteredBenchmark> benchmarks = signalBenchmarks();
+    for (int minutes : lengths) {
+        std::unique_ptr<Fixture> fixture;
+        for (const RegisteredBenchmark &benchmark : benchmarks) {
+            const QString name = QStringLiteral("%1/%2min").arg(benchmark.name).arg(minutes);
+            if (!filter.match(name).hasMatch())
+                continue;
+            if (!fixture)
+                fixture = std::make_unique<Fixture>(minutes);
+            BenchResult result{name, BenchState(minTime)};
+            benchmark.run(result.state, *fixture);
+            record(std::move(result));
+        }
+    }
+
+    for (const QString &filePath : parser.values(mp3Option)) {
+        const QString name = QStringLiteral("BM_Mp3Decode/%1").arg(QFileInfo(filePath).fileName());
+        if (!filter.match(name).hasMatch())
+            continue;
+        BenchResult result{name, BenchState(minTime)};
+        runMp3Decode(result.state, filePath);
+        record(std::move(result));
+    }
+
+    QJsonArray array;
+    bool anyFailed = false;
+    for (const BenchResult &result : results) {
+        array.append(toJson(result));
+        anyFailed = anyFailed || result.state.failed();
+    }
+    QJsonObject root;
+    root[QStringLiteral("context")] = context();
+    root[QStringLiteral("benchmarks")] = array;
+    const QByteArray document = QJsonDocument(root).toJson();
+
+    if (json)
+        out << document;
+    if (parser.isSet(outOption)) {
+        QFile file(parser.value(outOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(document) != document.size()) {
+            QTextStream(stderr) << "Failed to write " << file.fileName() << Qt::endl;
+            return 1;
+        }
+    }
+    return anyFailed ? 1 : 0;
+}
@@ -96,6 +96,7 @@ Item {
             showTrimBoundaries: root.recorded && root.segmentController && root.segmentIndex >= 0
             
             // Playback position tracking
+            playbackClock: root.segmentController ? function() { return root.segmentController.playbackClockMs() } : null
             playbackPositionMs: {
                 if (!root.segmentController || root.segmentIndex < 0)
                     return -1
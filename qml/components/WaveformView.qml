@@ -12,12 +12,25 @@ Item {
     property bool interactive: true  // Можно ли взаимодействовать с waveform
     property double playbackPositionMs: -1  // Позиция воспроизведения в миллисекундах (-1 если не воспроизводится)
     property double segmentStartMs: 0  // Начало сегмента в миллисекундах (для расчета относительной позиции)
+    property var playbackClock: null  // Функция, возвращающая плавную позицию воспроизведения (опрашивается каждый кадр)
+    property double _livePositionMs: -1
     property bool showTrimBoundaries: false  // Показывать ли линии обрезки
     property double trimStartMs: -1.0  // Начало обрезки в миллисекундах (-1 если не установлено)
     property double trimEndMs: -1.0  // Конец обрезки в миллисекундах (-1 если не установлено)
     
     // Helper property to trigger repaint when segments change
     property int _segmentsVersion: 0
+    // Длительность по данным громкости; та же шкала, что и у waveform
+    property double _durationMs: {
+        var maxDuration = 0
+        if (volumeData) {
+            for (var i = 0; i < volumeData.length; i++) {
+                if (volumeData[i] && volumeData[i].endMs > maxDuration)
+                    maxDuration = volumeData[i].endMs
+            }
+        }
+        return maxDuration
+    }
     
     signal segmentBoundaryChanged(int segmentIndex, double startMs, double endMs)
     signal trimBoundaryChanged(double trimStartMs, double trimEndMs)
@@ -44,13 +57,7 @@ Item {
                 if (!volumeData || volumeData.length === 0)
                     return
                 
-                var maxDuration = 0
-                for (var i = 0; i < volumeData.length; i++) {
-                    if (volumeData[i].endMs > maxDuration) {
-                        maxDuration = volumeData[i].endMs
-                    }
-                }
-                
+                var maxDuration = root._durationMs
                 if (maxDuration === 0)
                     return
                 
@@ -176,32 +183,12 @@ Item {
                     
                     ctx.setLineDash([])
                 }
-                
-                // Draw playback position indicator
-                if (playbackPositionMs >= 0) {
-                    // Calculate absolute position: segmentStartMs + playbackPositionMs
-                    var absolutePositionMs = segmentStartMs + playbackPositionMs
-                    var positionX = absolutePositionMs * scaleX
-                    
-                    if (positionX >= 0 && positionX <= width) {
-                        ctx.strokeStyle = "#ffd700"  // Золотой цвет для индикатора
-                        ctx.lineWidth = 3
-                        ctx.beginPath()
-                        ctx.moveTo(positionX, 0)
-                        ctx.lineTo(positionX, height)
-                        ctx.stroke()
-                        
-                        // Draw a small triangle at the top
-                        ctx.fillStyle = "#ffd700"
-                        ctx.beginPath()
-                        ctx.moveTo(positionX, 0)
-                        ctx.lineTo(positionX - 6, 10)
-                        ctx.lineTo(positionX + 6, 10)
-                        ctx.closePath()
-                        ctx.fill()
-                    }
-                }
             }
+
+            // Индикатор воспроизведения рисуется отдельным элементом ниже,
+            // холст перерисовывается только при изменении данных и размера
+            onWidthChanged: requestPaint()
+            onHeightChanged: requestPaint()
             
             Connections {
                 target: root
@@ -212,7 +199,6 @@ Item {
                 function onNoiseThresholdChanged() { waveformCanvas.requestPaint() }
                 function onShowSegmentsChanged() { waveformCanvas.requestPaint() }
                 function on_SegmentsVersionChanged() { waveformCanvas.requestPaint() }
-                function onPlaybackPositionMsChanged() { waveformCanvas.requestPaint() }
                 function onSegmentStartMsChanged() { waveformCanvas.requestPaint() }
                 function onEditableSegmentsChanged() { waveformCanvas.requestPaint() }
                 function onShowTrimBoundariesChanged() { waveformCanvas.requestPaint() }
@@ -223,11 +209,60 @@ Item {
                 function onDraggedTrimBoundaryChanged() { waveformCanvas.requestPaint() }
             }
             
+            // Samples the playback clock once per frame while this view is
+            // playing; only the playhead's x follows it
+            Timer {
+                interval: 16
+                repeat: true
+                running: root.visible && root.playbackClock !== null && root.playbackPositionMs >= 0
+                onRunningChanged: if (!running) root._livePositionMs = -1
+                onTriggered: root._livePositionMs = root.playbackClock()
+            }
+
             Component.onCompleted: {
                 console.log("WaveformView: Component.onCompleted, volumeData length:", root.volumeData ? root.volumeData.length : 0)
                 requestPaint()
             }
         }
+
+        // Draw playback position indicator
+        Item {
+            id: playhead
+            // Prefer the per-frame clock sample over the coarse position property
+            property double positionMs: root._livePositionMs >= 0 ? root._livePositionMs : root.playbackPositionMs
+            // Absolute position: segmentStartMs + positionMs
+            property double positionX: root._durationMs > 0
+                                       ? (root.segmentStartMs + positionMs) * waveformCanvas.width / root._durationMs
+                                       : -1
+            x: waveformCanvas.x + positionX - width / 2
+            y: waveformCanvas.y
+            width: 12
+            height: waveformCanvas.height
+            visible: root.playbackPositionMs >= 0 && positionX >= 0 && positionX <= waveformCanvas.width
+
+            Rectangle {
+                anchors.horizontalCenter: parent.horizontalCenter
+                width: 3
+                height: parent.height
+                color: "#ffd700"  // Золотой цвет для индикатора
+            }
+
+            // Small triangle at the top, painted once
+            Canvas {
+                width: parent.width
+                height: 10
+                onPaint: {
+                    var ctx = getContext("2d")
+                    ctx.fillStyle = "#ffd700"
+                    ctx.beginPath()
+                    ctx.moveTo(width / 2, 0)
+                    ctx.lineTo(0, height)
+                    ctx.lineTo(width, height)
+                    ctx.closePath()
+                    ctx.fill()
+                }
+            }
+        }
     }
     
     // Interactive area for adjusting boundaries
@@ -190,6 +190,48 @@ import "theme" as Theme
                 }
             }
         }
+
+        // Микрофон наготове и дуплекс: реверс оригинала звучит во время записи сегмента
+        Row {
+            anchors.verticalCenter: parent.verticalCenter
+            anchors.right: originalPlaybackSwitch.left
+            anchors.rightMargin: 16
+            spacing: 8
+            visible: originalPlaybackSwitch.visible
+
+            Switch {
+                anchors.verticalCenter: parent.verticalCenter
+                text: qsTr("Микрофон наготове")
+                checked: controller ? controller.recordingStandbyEnabled : false
+                onToggled: {
+                    if (controller) {
+                        controller.recordingStandbyEnabled = checked
+                    }
+                }
+            }
+
+            Switch {
+                id: duplexRecordingSwitch
+                anchors.verticalCenter: parent.verticalCenter
+                text: qsTr("Реверс при записи")
+                checked: controller ? controller.duplexRecordingEnabled : false
+                onToggled: {
+                    if (controller) {
+                        controller.duplexRecordingEnabled = checked
+                    }
+                }
+            }
+
+            Button {
+                anchors.verticalCenter: parent.verticalCenter
+                visible: duplexRecordingSwitch.checked
+                enabled: controller && !controller.latencyCalibrating
+                text: controller && controller.latencyCalibrating
+                      ? qsTr("Калибровка...")
+                      : qsTr("Задержка: %1 мс").arg(controller ? Math.round(controller.duplexLatencyMs) : 0)
+                onClicked: controller.calibrateLatency()
+            }
+        }
     }
 
     ColumnLayout {
@@ -490,6 +532,14 @@ import "theme" as Theme
                         color: "#c41e3a"  // единый цвет текста
                     }
 
+                    ProgressBar {
+                        Layout.fillWidth: true
+                        visible: controller && controller.loading
+                        from: 0.0
+                        to: 1.0
+                        value: controller ? controller.loadProgress : 0.0
+                    }
+
                     Item { Layout.fillHeight: true }
                 }
             }
@@ -1182,6 +1232,16 @@ import "theme" as Theme
             }
         }
         
+        // Один столбец на пиксель из предрассчитанной пирамиды пиков
+        function refreshWaveformPeaks() {
+            if (!controller || !controller.projectReady) {
+                settingsDialog.waveformVolumeData = []
+                return
+            }
+            var columns = Math.max(1, Math.round(waveformView.width))
+            settingsDialog.waveformVolumeData = controller.waveformPeaks(0, -1, columns, originalNoiseSlider.value, 0.7)
+        }
+        
         function updateWaveformData() {
             if (!controller || !controller.projectReady) {
                 settingsDialog.waveformVolumeData = []
@@ -1191,8 +1251,7 @@ import "theme" as Theme
             }
             
             // Получить данные анализа громкости
-            var volumeAnalysis = controller.analyzeVolume(50, originalNoiseSlider.value, 0.7)
-            settingsDialog.waveformVolumeData = volumeAnalysis
+            refreshWaveformPeaks()
             
             // Получить данные отрезков
             var segData = controller.getSegmentDataForWaveform()
@@ -1272,6 +1331,11 @@ import "theme" as Theme
                     segments: settingsDialog.waveformSegments
                     interactive: true
                     
+                    onWidthChanged: {
+                        if (settingsDialog.visible)
+                            settingsDialog.refreshWaveformPeaks()
+                    }
+                    
                     // Обработка изменений границ
                     onSegmentBoundaryChanged: {
                         // Границы обновляются в реальном времени в editableSegments
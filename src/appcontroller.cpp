@@ -4,10 +4,13 @@
 #include "audio/audioplaybackengine.h"
 #include "audio/audioproject.h"
 #include "audio/audiobuffer.h"
+#include "audio/duplexsession.h"
+#include "audio/glueengine.h"
+#include "audio/pcmcache.h"
 #include "audio/recordingengine.h"
 #include "audio/segmentmodel.h"
+#include "audio/segmenttrimmer.h"
 #include "audio/volumeanalyzer.h"
-#include "audio/wavutils.h"
 #include "persistence/projectserializer.h"
 #include "utils/logger.h"
 #include "utils/pathutils.h"
@@ -15,18 +18,30 @@
 #include <QFileInfo>
 #include <QFile>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QUrl>
 #include <QtGlobal>
 
+namespace {
+// Input kept in front of a segment take while the microphone is in standby
+constexpr int kRecordingPreRollMs = 300;
+// Decoded segments are shown at most this often while a source loads; each
+// update rebuilds the segment model
+constexpr int kPartialLoadIntervalMs = 500;
+} // namespace
+
 AppController::AppController(QObject *parent)
     : QObject(parent)
     , m_project(this)
     , m_decoder(new AudioFileDecoder(this))
     , m_playback(new AudioPlaybackEngine(this))
     , m_recorder(new RecordingEngine(this))
+    , m_duplex(new DuplexSession(m_playback, m_recorder, this))
+    , m_glue(new GlueEngine(this))
     , m_serializer(new ProjectSerializer(this))
 {
     m_segmentModel.setProject(&m_project);
+    m_editPool.setMaxThreadCount(1);
     setStatusMessage(tr("Готово"));
 
     // Pre-initialize audio input device to reduce delay when starting recording
@@ -41,6 +56,11 @@ AppController::AppController(QObject *parent)
 
     // Connect playback finished signals to update UI states
     connect(m_playback, &AudioPlaybackEngine::playbackFinished, this, [this]() {
+        // The guide of a duplex take or the calibration click; the take goes on
+        if (m_duplex->isActive() || m_duplex->isCalibrating()) {
+            LOG_INFO() << "Duplex guide finished";
+            return;
+        }
         clearPlaybackStates();
         setStatusMessage(tr("Воспроизведение завершено"));
         LOG_INFO() << "Playback finished";
@@ -54,6 +74,20 @@ AppController::AppController(QObject *parent)
     // Connect playback position updates
     connect(m_playback, &AudioPlaybackEngine::playbackPositionChanged, this, &AppController::playbackPositionChanged);
 
+    // A rewritten recording must not be served from memory
+    m_glue->setPcmCache(&m_pcmCache);
+    connect(m_recorder, &RecordingEngine::recordingSaved, this, [this](const QString &filePath) {
+        m_pcmCache.invalidate(filePath);
+    });
+
+    connect(m_duplex, &DuplexSession::calibrationFinished, this, [this](bool ok, double latencyMs) {
+        emit duplexSettingsChanged();
+        if (ok)
+            setStatusMessage(tr("Задержка откалибрована: %1 мс").arg(qRound(latencyMs)));
+        else
+            setStatusMessage(tr("Калибровка не удалась: микрофон не услышал щелчок или вывод звука не запустился"));
+    });
+
     // Connect recording engine signals
     connect(m_recorder, &RecordingEngine::recordingReady, this, [this]() {
         LOG_INFO() << "Recording ready signal received in AppController, sourceRecordingActive:" << m_sourceRecordingActive 
@@ -75,8 +109,7 @@ AppController::AppController(QObject *parent)
             const QString filePath = PathUtils::defaultTempRoot() + QDir::separator() + QStringLiteral("source_recording.wav");
             if (QFileInfo::exists(filePath)) {
                 loadAudioSource(filePath);
-                setStatusMessage(tr("Запись завершена и загружена"));
-                LOG_INFO() << "Source recording stopped and loaded";
+                LOG_INFO() << "Source recording stopped, loading it in background";
                 // Emit signals for source type and save state changes
                 emit sourceTypeChanged();
                 emit saveStateChanged();
@@ -92,6 +125,10 @@ AppController::AppController(QObject *parent)
 
 AppController::~AppController()
 {
+    cancelAudioSourceLoad();
+    cancelEditListBuild();
+    m_loadPool.waitForDone();
+    m_editPool.waitForDone();
 }
 
 SegmentModel *AppController::segmentModel()
@@ -114,6 +151,16 @@ bool AppController::projectReady() const
     return m_projectReady;
 }
 
+bool AppController::loading() const
+{
+    return m_loading;
+}
+
+double AppController::loadProgress() const
+{
+    return m_loadProgress;
+}
+
 QString AppController::currentSourceName() const
 {
     return m_currentSourceName;
@@ -136,12 +183,12 @@ QString AppController::segmentHintText() const
 
 bool AppController::interactionsEnabled() const
 {
-    return m_projectReady;
+    return m_projectReady && !m_loading;
 }
 
 bool AppController::canGlue() const
 {
-    return hasAllSegmentsRecorded();
+    return hasAllSegmentsRecorded() && !m_editBuildRunning;
 }
 
 bool AppController::canPlayGlue() const
@@ -163,7 +210,7 @@ bool AppController::canReverseSong() const
 bool AppController::canPlayReverse() const
 {
     // Reverse is created automatically during glue, so check if it exists
-    return !m_reversedSongPath.isEmpty() && QFileInfo::exists(m_reversedSongPath);
+    return reverseReady();
 }
 
 bool AppController::reversePlaybackActive() const
@@ -204,7 +251,7 @@ bool AppController::canSaveResults() const
         return true;
     
     // If source is loaded file, button is enabled only if reverse is ready
-    return !m_reversedSongPath.isEmpty() && QFileInfo::exists(m_reversedSongPath);
+    return reverseReady();
 }
 
 bool AppController::originalPlaybackEnabled() const
@@ -221,6 +268,47 @@ void AppController::setOriginalPlaybackEnabled(bool enabled)
     emit originalPlaybackEnabledChanged();
 }
 
+bool AppController::recordingStandbyEnabled() const
+{
+    return m_recordingStandbyEnabled;
+}
+
+void AppController::setRecordingStandbyEnabled(bool enabled)
+{
+    if (m_recordingStandbyEnabled == enabled)
+        return;
+
+    m_recordingStandbyEnabled = enabled;
+    updateRecordingStandby();
+    emit recordingStandbyEnabledChanged();
+}
+
+bool AppController::duplexRecordingEnabled() const
+{
+    return m_duplexRecordingEnabled;
+}
+
+void AppController::setDuplexRecordingEnabled(bool enabled)
+{
+    if (m_duplexRecordingEnabled == enabled)
+        return;
+
+    m_duplexRecordingEnabled = enabled;
+    emit duplexSettingsChanged();
+    if (enabled && !m_duplex->isCalibrated())
+        setStatusMessage(tr("Откалибруйте задержку, чтобы записи совпадали с оригиналом"));
+}
+
+bool AppController::latencyCalibrating() const
+{
+    return m_duplex->isCalibrating();
+}
+
+double AppController::duplexLatencyMs() const
+{
+    return m_duplex->latencyMs();
+}
+
 double AppController::originalNoiseThreshold() const
 {
     return m_originalNoiseThreshold;
@@ -258,6 +346,16 @@ double AppController::playbackPositionMs() const
     return m_playback->playbackPositionMs();
 }
 
+double AppController::playbackClockMs() const
+{
+    return m_playback->interpolatedPositionMs();
+}
+
+double AppController::playbackLatencyMs() const
+{
+    return m_playback->outputLatencyMs();
+}
+
 int AppController::activePlaybackSegmentIndex() const
 {
     return m_activePlaybackSegmentIndex;
@@ -277,34 +375,204 @@ void AppController::loadAudioSource(const QString &filePath)
 
     LOG_INFO() << "Loading audio source from" << filePath;
 
-    AudioBuffer buffer;
-    QString error;
-    if (!m_decoder->decodeFile(filePath, buffer, &error)) {
-        LOG_WARN() << "Decoding failed for" << filePath << ":" << error;
-        setStatusMessage(error);
+    // A new request supersedes any load still running: the stale worker sees the
+    // flag at its next decoded chunk and its results are dropped by generation
+    cancelAudioSourceLoad();
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_loadCancelFlag = cancelled;
+    const quint64 generation = ++m_loadGeneration;
+    const int segmentLengthSeconds = m_project.segmentLengthSeconds();
+    AudioFileDecoder *decoder = m_decoder;
+
+    // Nothing may keep running against the project the load replaces
+    stopProjectActivity();
+    // The microphone stays closed until the new source is ready
+    m_recorder->setPreRollMs(0);
+    m_loading = true;
+    emit loadingChanged();
+    emit interactionsStateChanged();
+    setLoadProgress(0.0);
+    setStatusMessage(tr("Загрузка файла: %1").arg(QFileInfo(filePath).fileName()));
+
+    m_loadPool.start([this, decoder, filePath, generation, segmentLengthSeconds, cancelled]() {
+        AudioBuffer buffer;
+        QString error;
+        int lastPermille = -1;
+        // Final layout from the announced length; a segment is published once
+        // its last frame is decoded. Segments count from the end of the track,
+        // so they appear from the highest index down.
+        QVector<SegmentInfo> layout;
+        qint64 layoutFrames = -1;
+        int publishedSegments = 0;
+        QElapsedTimer publishClock;
+        const bool decoded = decoder->decodeFile(filePath, buffer, &error,
+            [&](qint64 decodedFrames, qint64 totalFrames) {
+                if (cancelled->load())
+                    return false;
+                const int permille = totalFrames > 0 ? static_cast<int>((decodedFrames * 1000) / totalFrames) : 0;
+                if (permille != lastPermille) {
+                    lastPermille = permille;
+                    QMetaObject::invokeMethod(this, [this, generation, permille]() {
+                        if (generation == m_loadGeneration)
+                            setLoadProgress(permille / 1000.0);
+                    }, Qt::QueuedConnection);
+                }
+                if (decodedFrames >= totalFrames)
+                    return true; // The complete result follows
+
+                if (totalFrames != layoutFrames) {
+                    layoutFrames = totalFrames;
+                    layout = AudioProject::computeSegments(totalFrames, buffer.format().sampleRate(), segmentLengthSeconds);
+                    publishedSegments = 0;
+                }
+                QVector<SegmentInfo> ready;
+                for (const SegmentInfo &segment : layout) {
+                    if (segment.startFrame + segment.frameCount <= decodedFrames)
+                        ready.push_back(segment);
+                }
+                if (ready.size() > publishedSegments
+                    && (!publishClock.isValid() || publishClock.elapsed() >= kPartialLoadIntervalMs)) {
+                    publishClock.start();
+                    publishedSegments = ready.size();
+                    // Shares the decoded pages; decoding goes on in its own copy
+                    const AudioBuffer prefix = buffer;
+                    QMetaObject::invokeMethod(this, [this, generation, prefix, ready]() {
+                        publishPartialLoad(generation, prefix, ready);
+                    }, Qt::QueuedConnection);
+                }
+                return true;
+            });
+        if (cancelled->load()) {
+            LOG_INFO() << "Stale audio source load cancelled:" << filePath;
+            return;
+        }
+
+        QVector<SegmentInfo> segments;
+        WaveformPyramid waveform;
+        if (decoded) {
+            segments = AudioProject::computeSegments(buffer, segmentLengthSeconds);
+            waveform.build(buffer);
+        }
+
+        QMetaObject::invokeMethod(this, [this, generation, filePath, decoded, error, buffer, segments, waveform]() {
+            finishAudioSourceLoad(generation, filePath, decoded, error, buffer, segments, waveform);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AppController::cancelAudioSourceLoad()
+{
+    if (m_loadCancelFlag) {
+        m_loadCancelFlag->store(true);
+        m_loadCancelFlag.reset();
+    }
+    ++m_loadGeneration;
+    if (m_loading) {
+        m_loading = false;
+        emit loadingChanged();
+        emit interactionsStateChanged();
+    }
+}
+
+void AppController::setLoadProgress(double progress)
+{
+    if (qFuzzyCompare(m_loadProgress + 1.0, progress + 1.0))
         return;
+    m_loadProgress = progress;
+    emit loadProgressChanged();
+}
+
+void AppController::publishPartialLoad(quint64 generation, const AudioBuffer &prefix, const QVector<SegmentInfo> &segments)
+{
+    if (generation != m_loadGeneration)
+        return;
+
+    if (!m_loadBackup.valid) {
+        m_loadBackup.valid = true;
+        m_loadBackup.projectReady = m_projectReady;
+        m_loadBackup.buffer = m_project.originalBuffer();
+        m_loadBackup.waveform = m_project.waveform();
+        m_loadBackup.segments = m_project.segments();
+        m_loadBackup.songEdits = m_project.songEdits();
+        m_loadBackup.reverseEdits = m_project.reverseEdits();
+    }
+
+    // Rows are shown, but stay inactive until the whole source is loaded
+    if (m_projectReady) {
+        m_projectReady = false;
+        updateRecordingStandby();
+        emit projectReadinessChanged();
+        emit interactionsStateChanged();
+    }
+    m_project.originalBuffer() = prefix;
+    m_project.waveform().clear();
+    m_project.segments() = segments;
+    m_project.resetSegmentStatuses();
+    emit m_project.segmentsUpdated();
+    LOG_INFO() << "Published" << segments.size() << "decoded segments while loading";
+}
+
+void AppController::restoreLoadBackup()
+{
+    if (!m_loadBackup.valid)
+        return;
+
+    m_project.originalBuffer() = m_loadBackup.buffer;
+    m_project.waveform() = m_loadBackup.waveform;
+    m_project.segments() = m_loadBackup.segments;
+    m_project.songEdits() = m_loadBackup.songEdits;
+    m_project.reverseEdits() = m_loadBackup.reverseEdits;
+    const bool wasReady = m_loadBackup.projectReady;
+    m_loadBackup = LoadBackup();
+    emit m_project.segmentsUpdated();
+
+    if (m_projectReady != wasReady) {
+        m_projectReady = wasReady;
+        updateRecordingStandby();
+        emit projectReadinessChanged();
+        emit interactionsStateChanged();
     }
+    emit canAdjustSegmentLengthChanged();
+    emit segmentHintTextChanged();
+    LOG_INFO() << "Restored the project replaced by an unfinished load";
+}
 
-    // Delete old reverse files before loading new source
-    const QString cutsDir = PathUtils::defaultCutsRoot();
-    if (QDir(cutsDir).exists()) {
-        QDir dir(cutsDir);
-        const QStringList filters = QStringList() << "segment_*_reverse.wav";
-        const QFileInfoList files = dir.entryInfoList(filters, QDir::Files);
-        for (const QFileInfo &fileInfo : files) {
-            QFile::remove(fileInfo.absoluteFilePath());
-            LOG_INFO() << "Removed old reverse file:" << fileInfo.absoluteFilePath();
-        }
+void AppController::finishAudioSourceLoad(quint64 generation, const QString &filePath, bool decoded, const QString &error,
+                                          const AudioBuffer &buffer, const QVector<SegmentInfo> &segments,
+                                          const WaveformPyramid &waveform)
+{
+    if (generation != m_loadGeneration) {
+        LOG_INFO() << "Dropping superseded load result for" << filePath;
+        return;
     }
 
+    m_loadCancelFlag.reset();
+    m_loading = false;
+    emit loadingChanged();
+    emit interactionsStateChanged();
+
+    if (!decoded) {
+        LOG_WARN() << "Decoding failed for" << filePath << ":" << error;
+        // Segments already shown from this file are dropped again
+        restoreLoadBackup();
+        setStatusMessage(error);
+        updateRecordingStandby();
+        return;
+    }
+    m_loadBackup = LoadBackup();
+    setLoadProgress(1.0);
+
     m_project.originalBuffer() = buffer;
+    m_project.waveform() = waveform;
     m_project.setOriginalFilePath(filePath);
     ensureProjectNameFromSource(filePath);
-    m_project.splitIntoSegments();
+    m_project.segments() = segments;
     m_project.resetSegmentStatuses();
+    emit m_project.segmentsUpdated();
 
     m_projectReady = true;
     m_currentSourceName = QFileInfo(filePath).fileName();
+    updateRecordingStandby();
 
     emit currentSourceNameChanged();
     emit projectReadinessChanged();
@@ -374,7 +642,7 @@ void AppController::stopSourceRecording()
     emit recordingDialogVisibleChanged();
     emit recordingReadyChanged();
 
-    // Stop recording (will wait 0.25 seconds to capture tail, then emit recordingStopped)
+    // Stop recording (waits for the device latency to capture the tail, then emits recordingStopped)
     // NOTE: Don't set m_sourceRecordingActive = false here!
     // We need it to be true when recordingStopped signal arrives
     m_recorder->stop();
@@ -409,7 +677,7 @@ void AppController::saveProjectTo(const QString &filePath)
     // Check if source is from microphone recording
     bool isMicSource = isMicrophoneSource();
     const QString originalPath = m_project.originalFilePath();
-    bool reverseReady = !m_reversedSongPath.isEmpty() && QFileInfo::exists(m_reversedSongPath);
+    const bool reverseReady = this->reverseReady();
     
     bool savedSomething = false;
     QStringList savedFiles;
@@ -456,12 +724,10 @@ void AppController::saveProjectTo(const QString &filePath)
         if (QFileInfo::exists(reversedFilePath)) {
             QFile::remove(reversedFilePath);
         }
-        if (QFile::copy(m_reversedSongPath, reversedFilePath)) {
+        if (exportReversedSong(reversedFilePath)) {
             savedFiles << reversedFilePath;
             savedSomething = true;
             LOG_INFO() << "Saved reversed song to" << reversedFilePath;
-        } else {
-            LOG_WARN() << "Failed to copy reversed song from" << m_reversedSongPath << "to" << reversedFilePath;
         }
     }
     // Case 3: Loaded file + reverse ready → save only reverse
@@ -474,12 +740,10 @@ void AppController::saveProjectTo(const QString &filePath)
         if (QFileInfo::exists(reversedFilePath)) {
             QFile::remove(reversedFilePath);
         }
-        if (QFile::copy(m_reversedSongPath, reversedFilePath)) {
+        if (exportReversedSong(reversedFilePath)) {
             savedFiles << reversedFilePath;
             savedSomething = true;
             LOG_INFO() << "Saved reversed song to" << reversedFilePath;
-        } else {
-            LOG_WARN() << "Failed to copy reversed song from" << m_reversedSongPath << "to" << reversedFilePath;
         }
     }
     // Case 4: Loaded file + reverse NOT ready → should not happen (button disabled)
@@ -502,6 +766,14 @@ void AppController::saveProjectTo(const QString &filePath)
 void AppController::openProjectFrom(const QString &projectFilePath)
 {
     LOG_INFO() << "Opening project from" << projectFilePath;
+
+    // The opened project replaces whatever a pending load would publish;
+    // if it already published, the project it replaced comes back first
+    cancelAudioSourceLoad();
+    restoreLoadBackup();
+    stopProjectActivity();
+    // The microphone stays closed until the new project is ready
+    m_recorder->setPreRollMs(0);
     
     // Convert URL to local file path if needed
     QString localPath = projectFilePath;
@@ -521,31 +793,16 @@ void AppController::openProjectFrom(const QString &projectFilePath)
     }
     
     // If .vups file is provided, find project.json in the project directory
-    QString actualProjectPath = localPath;
-    QFileInfo fileInfo(localPath);
-    if (fileInfo.suffix().toLower() == QStringLiteral("vups")) {
-        // .vups file points to project directory
-        QString projectName = fileInfo.completeBaseName();
-        QString projectDir = fileInfo.absolutePath() + QDir::separator() + projectName;
-        QString projectJsonPath = projectDir + QDir::separator() + QStringLiteral("project.json");
-        
-        if (QFileInfo::exists(projectJsonPath)) {
-            actualProjectPath = projectJsonPath;
-            LOG_INFO() << "Found project.json at" << actualProjectPath;
-        } else {
-            // If project.json not found in directory, try to use .vups file directly
-            // (in case it contains the project data)
-            actualProjectPath = projectFilePath;
-            LOG_INFO() << "Using .vups file directly as project file";
-        }
-    }
+    const QString actualProjectPath = ProjectSerializer::resolveProjectFile(localPath);
     
     QString info;
     if (!m_serializer->load(actualProjectPath, m_project, &info)) {
         setStatusMessage(info);
         LOG_WARN() << "Failed to open project:" << info;
+        updateRecordingStandby();
         return;
     }
+    m_project.clearEdits();
 
     // Load original audio file if it exists
     const QString originalPath = m_project.originalFilePath();
@@ -554,6 +811,7 @@ void AppController::openProjectFrom(const QString &projectFilePath)
         QString error;
         if (m_decoder->decodeFile(originalPath, buffer, &error)) {
             m_project.originalBuffer() = buffer;
+            m_project.rebuildWaveform();
             LOG_INFO() << "Original audio loaded from project";
         } else {
             LOG_WARN() << "Failed to load original audio:" << error;
@@ -580,7 +838,7 @@ void AppController::openProjectFrom(const QString &projectFilePath)
     }
     
     // Try to find glued song files
-    QString fragmentSongPath = projectDir.absoluteFilePath(projectName + QStringLiteral("_fragment_song.wav"));
+    QString fragmentSongPath = PathUtils::composeFragmentSongFile(projectDir.absolutePath(), projectName);
     if (QFileInfo::exists(fragmentSongPath)) {
         m_project.setDecodedFilePath(fragmentSongPath);
         LOG_INFO() << "Found glued song at" << fragmentSongPath;
@@ -588,7 +846,7 @@ void AppController::openProjectFrom(const QString &projectFilePath)
         LOG_INFO() << "Glued song file not found at" << fragmentSongPath;
     }
     
-    QString reversFragmentSongPath = projectDir.absoluteFilePath(projectName + QStringLiteral("_revers_fragment_song.wav"));
+    QString reversFragmentSongPath = PathUtils::composeReverseFragmentSongFile(projectDir.absolutePath(), projectName);
     if (QFileInfo::exists(reversFragmentSongPath)) {
         m_reversedSongPath = reversFragmentSongPath;
         LOG_INFO() << "Found reversed glued song at" << reversFragmentSongPath;
@@ -602,6 +860,7 @@ void AppController::openProjectFrom(const QString &projectFilePath)
 
     m_projectReady = true;
     m_currentSourceName = m_project.projectName().isEmpty() ? QFileInfo(projectFilePath).completeBaseName() : m_project.projectName();
+    updateRecordingStandby();
     emit currentSourceNameChanged();
     emit projectReadinessChanged();
     emit canAdjustSegmentLengthChanged();
@@ -675,16 +934,22 @@ void AppController::toggleSegmentRecording(int segmentIndex)
         emit recordingDialogVisibleChanged();
         emit recordingReadyChanged();
 
-        // Stop recording (will wait 0.25 seconds to capture tail, then emit recordingStopped)
+        // Stop recording (waits for the device latency to capture the tail, then emits recordingStopped)
         // Don't remove from active set yet - stopCurrentRecording needs it
-        m_recorder->stop();
+        if (m_duplex->isActive())
+            m_duplex->stop();
+        else
+            m_recorder->stop();
         setStatusMessage(tr("Завершение записи сегмента %1...").arg(segmentIndex));
         
         // Connect to recordingStopped to finalize segment recording
         // We need to track which segment is being finalized
         // Use a lambda that captures segmentIndex and disconnects itself
+        // The take belongs to this file; the project may have been replaced by then
+        const auto *recordedSegment = segmentByDisplayIndex(segmentIndex);
+        const QString recordingPath = recordedSegment ? recordedSegment->recordingPath : QString();
         QMetaObject::Connection *connection = new QMetaObject::Connection();
-        *connection = connect(m_recorder, &RecordingEngine::recordingStopped, this, [this, segmentIndex, connection]() {
+        *connection = connect(m_recorder, &RecordingEngine::recordingStopped, this, [this, segmentIndex, recordingPath, connection]() {
             // Disconnect immediately to ensure this is only called once
             disconnect(*connection);
             delete connection;
@@ -693,9 +958,15 @@ void AppController::toggleSegmentRecording(int segmentIndex)
             m_activeSegmentRecordings.remove(segmentIndex);
             
             auto *segment = segmentByDisplayIndex(segmentIndex);
-            if (segment && QFileInfo::exists(segment->recordingPath)) {
+            if (!segment || segment->recordingPath != recordingPath) {
+                LOG_INFO() << "Segment take" << recordingPath << "finished after its project was replaced";
+                return;
+            }
+            if (QFileInfo::exists(segment->recordingPath)) {
                 segment->hasRecording = true;
                 emit m_project.segmentsUpdated();
+                // Edit lists dropped when the take started are rebuilt from it
+                refreshSongEdits();
                 setStatusMessage(tr("Запись сегмента %1 завершена").arg(segmentIndex));
                 LOG_INFO() << "Segment recording stopped for index" << segmentIndex << "saved to" << segment->recordingPath;
             } else {
@@ -709,10 +980,15 @@ void AppController::toggleSegmentRecording(int segmentIndex)
         return;
     }
 
-    // Stop all other playback/recording
+    if (m_duplex->isCalibrating()) {
+        setStatusMessage(tr("Дождитесь окончания калибровки задержки"));
+        return;
+    }
+
+    // Stop all other playback/recording; a duplex take starts its own guide
     m_playback->stopAll();
     // Stop recorder if it's recording
-    // Note: stop() will wait 0.25s for tail capture, but we need to start new recording
+    // Note: stop() waits for the device latency to capture the tail, but we need to start new recording
     // So we just call stop() and let it handle cleanup in background
     if (m_recorder->isRecording()) {
         m_recorder->stop();
@@ -751,17 +1027,18 @@ void AppController::toggleSegmentRecording(int segmentIndex)
     segment->reversePath.clear();
     emit m_project.segmentsUpdated();
 
-    // Use the same format as original buffer
-    QAudioFormat format = m_project.originalBuffer().format();
-    if (!format.isValid()) {
-        format.setChannelCount(1);
-        format.setSampleRate(44100);
-        format.setSampleSize(16);
-        format.setSampleType(QAudioFormat::SignedInt);
-        format.setCodec(QStringLiteral("audio/pcm"));
-        format.setByteOrder(QAudioFormat::LittleEndian);
+    // The glued song reads the recording just deleted; it is rebuilt once
+    // the take is finished
+    if (!m_project.songEdits().isEmpty() || m_editBuildRunning) {
+        cancelEditListBuild();
+        m_project.clearEdits();
+        m_editsStale = true;
+        emit saveStateChanged();
+        emit reverseStateChanged();
     }
 
+    const QAudioFormat format = segmentRecordingFormat();
+
     // Show dialog BEFORE starting recording (same as source recording)
     m_recordingDialogVisible = true;
     m_recordingReady = false;
@@ -769,7 +1046,13 @@ void AppController::toggleSegmentRecording(int segmentIndex)
     emit recordingReadyChanged();
     LOG_INFO() << "Dialog shown for segment recording, recordingReady set to false";
 
-    if (!m_recorder->startRecording(segment->recordingPath, format)) {
+    // In duplex mode the reversed original plays while the take is recorded,
+    // and the take is shifted by the calibrated latency to line up with it
+    const bool started = m_duplexRecordingEnabled
+        ? m_duplex->start(m_project.originalBuffer().view(segment->startFrame, segment->frameCount), true,
+                          segment->recordingPath, format)
+        : m_recorder->startRecording(segment->recordingPath, format);
+    if (!started) {
         // Hide dialog if recording failed
         m_recordingDialogVisible = false;
         emit recordingDialogVisibleChanged();
@@ -783,135 +1066,6 @@ void AppController::toggleSegmentRecording(int segmentIndex)
     LOG_INFO() << "Segment recording initialization started for index" << segmentIndex << "to" << segment->recordingPath << "recordingReady:" << m_recordingReady;
 }
 
-// Helper function to trim noise from segment start and end
-// If trimStartMs and trimEndMs are >= 0, they are used instead of automatic detection
-static QByteArray trimSegmentNoise(const QByteArray &pcm, const QAudioFormat &format, double noiseThreshold, double trimStartMs = -1.0, double trimEndMs = -1.0)
-{
-    if (pcm.isEmpty() || !format.isValid()) {
-        return pcm;
-    }
-    
-    // Create AudioBuffer from PCM data
-    AudioBuffer buffer;
-    buffer.setFormat(format);
-    buffer.data() = pcm;
-    
-    if (buffer.frameCount() == 0) {
-        return pcm;
-    }
-    
-    // Analyze volume with 100ms windows
-    const QVector<VolumeLevel> levels = VolumeAnalyzer::analyzeVolume(
-        buffer, 100, noiseThreshold, 0.7);
-    
-    if (levels.isEmpty()) {
-        return pcm;
-    }
-    
-    const qint64 sampleRate = format.sampleRate();
-    if (sampleRate <= 0) {
-        return pcm;
-    }
-    
-    qint64 startFrame = 0;
-    qint64 endFrame = buffer.frameCount();
-    
-    // Use manual trim boundaries if provided
-    if (trimStartMs >= 0 && trimEndMs >= 0 && trimStartMs < trimEndMs) {
-        startFrame = static_cast<qint64>((trimStartMs * sampleRate) / 1000.0);
-        endFrame = static_cast<qint64>((trimEndMs * sampleRate) / 1000.0);
-        startFrame = qBound(0LL, startFrame, buffer.frameCount());
-        endFrame = qBound(0LL, endFrame, buffer.frameCount());
-        LOG_INFO() << "Using manual trim boundaries: startMs:" << trimStartMs << "endMs:" << trimEndMs 
-                   << "startFrame:" << startFrame << "endFrame:" << endFrame;
-    } else {
-        // Automatic detection
-        LOG_INFO() << "Trimming segment: total levels:" << levels.size() 
-                   << "noiseThreshold:" << noiseThreshold
-                   << "totalFrames:" << buffer.frameCount();
-        
-        // Log first few and last few levels for debugging
-        for (int i = 0; i < qMin(5, levels.size()); ++i) {
-            const VolumeLevel &level = levels[i];
-            LOG_INFO() << "Level" << i << "startFrame:" << level.startFrame 
-                       << "frameCount:" << level.frameCount 
-                       << "rms:" << level.rmsLevel 
-                       << "isQuiet:" << level.isQuiet 
-                       << "isLoud:" << level.isLoud;
-        }
-        if (levels.size() > 5) {
-            for (int i = qMax(5, levels.size() - 5); i < levels.size(); ++i) {
-                const VolumeLevel &level = levels[i];
-                LOG_INFO() << "Level" << i << "startFrame:" << level.startFrame 
-                           << "frameCount:" << level.frameCount 
-                           << "rms:" << level.rmsLevel 
-                           << "isQuiet:" << level.isQuiet 
-                           << "isLoud:" << level.isLoud;
-            }
-        }
-        
-        // Find start of real sound
-        // Logic: find first loud section (any length), trim everything before it
-        // (all quiet sections, regardless of their length - 1ms or 10000ms, doesn't matter)
-        for (int i = 0; i < levels.size(); ++i) {
-            const VolumeLevel &level = levels[i];
-            if (!level.isQuiet) {
-                // Found first loud section (any length) - this is the real start
-                // Trim everything before it (all quiet sections, regardless of length)
-                startFrame = level.startFrame;
-                LOG_INFO() << "Found start at frame" << startFrame << "from loud section" << i 
-                           << "frames:" << level.frameCount << "rms:" << level.rmsLevel;
-                break;
-            }
-            // Quiet section - continue searching, will be trimmed regardless of length
-        }
-        
-        // Find end of real sound
-        // Logic: find last loud section (any length), trim everything after it
-        // (all quiet sections, regardless of their length - 1ms or 10000ms, doesn't matter)
-        for (int i = levels.size() - 1; i >= 0; --i) {
-            const VolumeLevel &level = levels[i];
-            if (!level.isQuiet) {
-                // Found last loud section (any length) - this is the real end
-                // Trim everything after it (all quiet sections, regardless of length)
-                endFrame = level.startFrame + level.frameCount;
-                LOG_INFO() << "Found end at frame" << endFrame << "from loud section" << i 
-                           << "frames:" << level.frameCount << "rms:" << level.rmsLevel;
-                break;
-            }
-            // Quiet section - continue searching backwards, will be trimmed regardless of length
-        }
-    }
-    
-    // Ensure start and end don't overlap
-    if (startFrame >= endFrame) {
-        // Overlap detected - adjust to prevent it
-        if (startFrame > 0 && endFrame < buffer.frameCount()) {
-            // Both were found, but they overlap - use middle point
-            qint64 middleFrame = (startFrame + endFrame) / 2;
-            startFrame = qMin(startFrame, middleFrame);
-            endFrame = qMax(endFrame, middleFrame + 1);
-            LOG_WARN() << "Start and end overlapped, adjusted to startFrame:" << startFrame 
-                       << "endFrame:" << endFrame;
-        } else {
-            // No valid sound found, return empty
-            LOG_WARN() << "No valid sound found in segment after trimming, startFrame:" 
-                       << startFrame << "endFrame:" << endFrame;
-            return QByteArray();
-        }
-    }
-    
-    const qint64 trimmedFrameCount = endFrame - startFrame;
-    QByteArray trimmed = buffer.sliceFrames(startFrame, trimmedFrameCount);
-    
-    LOG_INFO() << "Trimmed segment: original frames:" << buffer.frameCount() 
-               << "trimmed frames:" << trimmedFrameCount 
-               << "removed from start:" << startFrame << "frames"
-               << "removed from end:" << (buffer.frameCount() - endFrame) << "frames";
-    
-    return trimmed;
-}
-
 void AppController::toggleSegmentOriginalPlayback(int segmentIndex)
 {
     if (m_activeOriginalPlayback.contains(segmentIndex)) {
@@ -941,15 +1095,15 @@ void AppController::toggleSegmentOriginalPlayback(int segmentIndex)
         return;
     }
 
-    // Extract segment from original buffer
-    const QByteArray segmentData = m_project.originalBuffer().sliceFrames(segment->startFrame, segment->frameCount);
-    if (segmentData.isEmpty()) {
+    // Played straight from the pages of the original buffer, nothing is copied
+    const AudioView segmentView = m_project.originalBuffer().view(segment->startFrame, segment->frameCount);
+    if (segmentView.isEmpty()) {
         setStatusMessage(tr("Ошибка: сегмент %1 пуст").arg(segmentIndex));
         LOG_WARN() << "Empty segment data for index" << segmentIndex;
         return;
     }
 
-    if (m_playback->playBuffer(segmentData, m_project.originalBuffer().format())) {
+    if (m_playback->playView(segmentView)) {
         m_activeOriginalPlayback.insert(segmentIndex);
         m_activePlaybackSegmentIndex = segmentIndex;
         m_isPlayingOriginalSegment = true;
@@ -999,11 +1153,10 @@ void AppController::toggleSegmentRecordedPlayback(int segmentIndex)
         return;
     }
 
-    // Load and trim the recording (same as in glueSegments)
-    QByteArray pcm;
-    QAudioFormat format;
+    // Load (from the PCM cache when possible) and trim the recording (same as in glueSegments)
     QString error;
-    if (!WavUtils::readWavFile(segment->recordingPath, pcm, format, &error)) {
+    const PcmCache::EntryPtr recording = m_pcmCache.load(segment->recordingPath, &error);
+    if (!recording) {
         setStatusMessage(tr("Ошибка чтения записи сегмента %1: %2").arg(segmentIndex).arg(error));
         LOG_WARN() << "Failed to read segment recording:" << segment->recordingPath << error;
         return;
@@ -1012,22 +1165,30 @@ void AppController::toggleSegmentRecordedPlayback(int segmentIndex)
     // Trim noise from start and end (use manual boundaries if set)
     double trimStartMs = segment->trimStartMs;
     double trimEndMs = segment->trimEndMs;
-    QByteArray trimmedPcm = trimSegmentNoise(pcm, format, m_segmentNoiseThreshold, trimStartMs, trimEndMs);
-    if (trimmedPcm.isEmpty()) {
+    const PcmCache::ProfilePtr profile = m_pcmCache.profile(segment->recordingPath, 100, &error);
+    if (!profile) {
+        setStatusMessage(tr("Ошибка чтения записи сегмента %1: %2").arg(segmentIndex).arg(error));
+        LOG_WARN() << "Failed to measure segment recording:" << segment->recordingPath << error;
+        return;
+    }
+    const TrimRange range = SegmentTrimmer(m_segmentNoiseThreshold).trim(*profile, trimStartMs, trimEndMs);
+    // Plays the cached pages in place
+    const AudioView trimmed = recording->audio.view(range.startFrame, range.frameCount());
+    if (trimmed.isEmpty()) {
         setStatusMessage(tr("Ошибка: сегмент %1 не содержит звука после обрезки").arg(segmentIndex));
         LOG_WARN() << "Segment" << segmentIndex << "is empty after trimming";
         return;
     }
 
     // Play the trimmed audio
-    if (m_playback->playBuffer(trimmedPcm, format)) {
+    if (m_playback->playView(trimmed)) {
         m_activeRecordedPlayback.insert(segmentIndex);
         m_activePlaybackSegmentIndex = segmentIndex;
         m_isPlayingOriginalSegment = false;
         emit playbackPositionChanged();
         setStatusMessage(tr("Воспроизведение записи сегмента %1 (обрезано)").arg(segmentIndex));
         LOG_INFO() << "Started recorded playback for segment" << segmentIndex 
-                   << "original size:" << pcm.size() << "trimmed size:" << trimmedPcm.size();
+                   << "original size:" << recording->audio.byteCount() << "trimmed size:" << trimmed.byteCount();
         emit m_project.segmentsUpdated();
     } else {
         setStatusMessage(tr("Ошибка воспроизведения записи сегмента %1").arg(segmentIndex));
@@ -1061,114 +1222,10 @@ void AppController::toggleSegmentReversePlayback(int segmentIndex)
         return;
     }
 
-    // Check if reverse file exists, create if needed
-    if (segment->reversePath.isEmpty()) {
-        const QString cutsDir = PathUtils::defaultCutsRoot();
-        PathUtils::ensureDirectory(cutsDir);
-        segment->reversePath = PathUtils::composeSegmentReverseFile(cutsDir, segmentIndex);
-    }
-
-    // Delete existing reverse file if it's corrupted or needs recreation
-    if (QFileInfo::exists(segment->reversePath)) {
-        QFileInfo fileInfo(segment->reversePath);
-        if (fileInfo.size() < 44) { // WAV header is 44 bytes minimum
-            LOG_INFO() << "Removing corrupted reverse file for segment" << segmentIndex << "size" << fileInfo.size();
-            QFile::remove(segment->reversePath);
-        } else {
-            // Try to verify file is valid by attempting to read it
-            QByteArray testPcm;
-            QAudioFormat testFormat;
-            QString testError;
-            if (!WavUtils::readWavFile(segment->reversePath, testPcm, testFormat, &testError)) {
-                LOG_INFO() << "Removing invalid reverse file for segment" << segmentIndex << "error:" << testError;
-                QFile::remove(segment->reversePath);
-            } else {
-                LOG_INFO() << "Reverse file exists and is valid for segment" << segmentIndex;
-            }
-        }
-    }
-
-    if (!QFileInfo::exists(segment->reversePath)) {
-        LOG_INFO() << "Creating reverse file for segment" << segmentIndex;
-        QByteArray pcm;
-        QAudioFormat format;
-        QString error;
-
-        // Always create reverse from original buffer (button is "Реверс оригинал")
-        LOG_INFO() << "Creating reverse from original segment" << segmentIndex;
-        const QByteArray segmentData = m_project.originalBuffer().sliceFrames(segment->startFrame, segment->frameCount);
-        if (segmentData.isEmpty()) {
-            setStatusMessage(tr("Ошибка: сегмент %1 пуст").arg(segmentIndex));
-            LOG_WARN() << "Empty segment data for reverse, index" << segmentIndex;
-            return;
-        }
-
-        format = m_project.originalBuffer().format();
-        pcm = segmentData;
-        
-        LOG_INFO() << "Extracted segment" << segmentIndex << "from original" 
-                   << "size" << pcm.size() << "format:" << format.channelCount() << "ch" << format.sampleRate() << "Hz"
-                   << format.sampleSize() << "bit" << (format.sampleType() == QAudioFormat::SignedInt ? "signed" : "float");
-        
-        if (!format.isValid()) {
-            setStatusMessage(tr("Ошибка: неверный формат для сегмента %1").arg(segmentIndex));
-            LOG_WARN() << "Invalid format for segment" << segmentIndex;
-            return;
-        }
-
-        // Ensure format is 16-bit PCM for WAV writing
-        // Note: format may already be 16-bit PCM from MP3 decoder, but we ensure it's correct
-        if (format.sampleSize() != 16 || format.sampleType() != QAudioFormat::SignedInt) {
-            LOG_INFO() << "Format needs conversion for segment" << segmentIndex 
-                       << "current:" << format.sampleSize() << "bit" 
-                       << (format.sampleType() == QAudioFormat::SignedInt ? "signed" : "float");
-            // Data is already in correct format from decoder, just update format metadata
-            format.setSampleSize(16);
-            format.setSampleType(QAudioFormat::SignedInt);
-            format.setCodec(QStringLiteral("audio/pcm"));
-            format.setByteOrder(QAudioFormat::LittleEndian);
-        }
-        
-        // Validate format and data
-        if (!format.isValid() || pcm.isEmpty()) {
-            setStatusMessage(tr("Ошибка: неверный формат или пустые данные для сегмента %1").arg(segmentIndex));
-            LOG_WARN() << "Invalid format or empty data for reverse, segment" << segmentIndex 
-                       << "format valid:" << format.isValid() << "pcm size:" << pcm.size();
-            return;
-        }
-
-        // Create reversed audio
-        QByteArray reversed = AudioBuffer::reverseSamples(pcm, format);
-        if (reversed.isEmpty()) {
-            setStatusMessage(tr("Ошибка: не удалось создать реверс для сегмента %1").arg(segmentIndex));
-            LOG_WARN() << "Failed to reverse samples for segment" << segmentIndex;
-            return;
-        }
-
-        LOG_INFO() << "Writing reverse file for segment" << segmentIndex << "size" << reversed.size() 
-                   << "format" << format.channelCount() << "ch" << format.sampleRate() << "Hz"
-                   << format.sampleSize() << "bit" << "to" << segment->reversePath;
-        if (!WavUtils::writeWavFile(segment->reversePath, format, reversed, &error)) {
-            setStatusMessage(tr("Ошибка создания реверса сегмента %1: %2").arg(segmentIndex).arg(error));
-            LOG_WARN() << "Failed to write reverse file:" << segment->reversePath << error;
-            return;
-        }
-        
-        // Verify file was created and has data
-        QFileInfo fileInfo(segment->reversePath);
-        if (!fileInfo.exists() || fileInfo.size() < 44) { // WAV header is 44 bytes minimum
-            setStatusMessage(tr("Ошибка: файл реверса создан некорректно для сегмента %1").arg(segmentIndex));
-            LOG_WARN() << "Reverse file verification failed for segment" << segmentIndex 
-                       << "exists:" << fileInfo.exists() << "size:" << fileInfo.size();
-            return;
-        }
-        
-        segment->hasReverse = true;
-        emit m_project.segmentsUpdated();
-        LOG_INFO() << "Created reverse file for segment" << segmentIndex << "at" << segment->reversePath << "size" << fileInfo.size();
-    }
-
-    if (m_playback->playFile(segment->reversePath)) {
+    // The reverse is read backwards straight from the original buffer; the
+    // segment_XX_reverse.wav file is only written when the project is saved,
+    // so hasReverse and reversePath stay untouched here
+    if (m_playback->playReverse(m_project.originalBuffer().view(segment->startFrame, segment->frameCount))) {
         m_activeReversePlayback.insert(segmentIndex);
         setStatusMessage(tr("Воспроизведение реверса сегмента %1").arg(segmentIndex));
         LOG_INFO() << "Started reverse playback for segment" << segmentIndex;
@@ -1187,162 +1244,18 @@ void AppController::glueSegments()
         return;
     }
 
-    setStatusMessage(tr("Склейка сегментов..."));
-    LOG_INFO() << "Glue segments requested";
-
-    const auto &segments = m_project.segments();
-    if (segments.isEmpty()) {
+    if (m_project.segments().isEmpty()) {
         setStatusMessage(tr("Нет сегментов для склейки"));
         LOG_WARN() << "No segments to glue";
         return;
     }
 
-    // Read all recorded segments and trim noise
-    // Segments are stored in reverse order (from end to start of song):
-    // segment 1 = end of song, segment 2, segment 3, segment 4 = start of song
-    // We glue them in display order (1 → 2 → 3 → 4) so that after reversing
-    // the glued song, we get correct order (4 → 3 → 2 → 1 = start to end)
-    QByteArray gluedPcm;
-    QAudioFormat format;
-    bool formatSet = false;
-
-    // Iterate in display order (as shown in the list)
-    for (const auto &segment : segments) {
-        if (segment.recordingPath.isEmpty() || !QFileInfo::exists(segment.recordingPath)) {
-            setStatusMessage(tr("Файл записи сегмента %1 не найден").arg(segment.displayIndex));
-            LOG_WARN() << "Recording file not found for segment" << segment.displayIndex;
-            return;
-        }
-
-        QByteArray pcm;
-        QAudioFormat segFormat;
-        QString error;
-        if (!WavUtils::readWavFile(segment.recordingPath, pcm, segFormat, &error)) {
-            setStatusMessage(tr("Ошибка чтения сегмента %1: %2").arg(segment.displayIndex).arg(error));
-            LOG_WARN() << "Failed to read segment" << segment.displayIndex << error;
-            return;
-        }
-
-        if (!formatSet) {
-            format = segFormat;
-            formatSet = true;
-        } else {
-            // Ensure format matches
-            if (format.sampleRate() != segFormat.sampleRate() ||
-                format.channelCount() != segFormat.channelCount() ||
-                format.sampleSize() != segFormat.sampleSize()) {
-                setStatusMessage(tr("Несовместимые форматы сегментов"));
-                LOG_WARN() << "Incompatible segment formats";
-                return;
-            }
-        }
-
-        // Trim noise from start and end (use manual boundaries if set)
-        double trimStartMs = segment.trimStartMs;
-        double trimEndMs = segment.trimEndMs;
-        QByteArray trimmedPcm = trimSegmentNoise(pcm, segFormat, m_segmentNoiseThreshold, trimStartMs, trimEndMs);
-        if (trimmedPcm.isEmpty()) {
-            setStatusMessage(tr("Ошибка: сегмент %1 не содержит звука после обрезки").arg(segment.displayIndex));
-            LOG_WARN() << "Segment" << segment.displayIndex << "is empty after trimming";
-            return;
-        }
-
-        gluedPcm.append(trimmedPcm);
-        LOG_INFO() << "Added trimmed segment" << segment.displayIndex 
-                   << "to glued song, original size:" << pcm.size() 
-                   << "trimmed size:" << trimmedPcm.size();
-    }
-
-    // Save glued song (normal order)
-    const QString resultsDir = PathUtils::defaultResultsRoot();
-    PathUtils::ensureDirectory(resultsDir);
-    const QString songPath = PathUtils::composeSongFile(resultsDir, m_project.projectName());
-
-    QString error;
-    if (!WavUtils::writeWavFile(songPath, format, gluedPcm, &error)) {
-        setStatusMessage(tr("Ошибка сохранения склеенной песни: %1").arg(error));
-        LOG_WARN() << "Failed to write glued song:" << error;
-        return;
-    }
-
-    m_project.setDecodedFilePath(songPath);
-    LOG_INFO() << "Normal glued song saved to" << songPath;
-    
-    // Create reversed song: reverse each segment individually, then glue in reverse order
-    // Segments in array: [end of song (displayIndex 1), ..., start of song (displayIndex N)]
-    // For reverse: iterate backwards through array, reverse each segment, then glue
-    QByteArray reversedPcm;
-    bool reversedFormatSet = false;
-    
-    // Iterate in reverse order (from start of song to end of song)
-    for (int i = segments.size() - 1; i >= 0; --i) {
-        const auto &segment = segments[i];
-        if (segment.recordingPath.isEmpty() || !QFileInfo::exists(segment.recordingPath)) {
-            setStatusMessage(tr("Файл записи сегмента %1 не найден").arg(segment.displayIndex));
-            LOG_WARN() << "Recording file not found for segment" << segment.displayIndex;
-            return;
-        }
-
-        QByteArray pcm;
-        QAudioFormat segFormat;
-        if (!WavUtils::readWavFile(segment.recordingPath, pcm, segFormat, &error)) {
-            setStatusMessage(tr("Ошибка чтения сегмента %1: %2").arg(segment.displayIndex).arg(error));
-            LOG_WARN() << "Failed to read segment" << segment.displayIndex << error;
-            return;
-        }
-
-        if (!reversedFormatSet) {
-            format = segFormat;
-            reversedFormatSet = true;
-        } else {
-            // Ensure format matches
-            if (format.sampleRate() != segFormat.sampleRate() ||
-                format.channelCount() != segFormat.channelCount() ||
-                format.sampleSize() != segFormat.sampleSize()) {
-                setStatusMessage(tr("Несовместимые форматы сегментов"));
-                LOG_WARN() << "Incompatible segment formats";
-                return;
-            }
-        }
-
-        // Trim noise from start and end (use manual boundaries if set)
-        double trimStartMs = segment.trimStartMs;
-        double trimEndMs = segment.trimEndMs;
-        QByteArray trimmedPcm = trimSegmentNoise(pcm, segFormat, m_segmentNoiseThreshold, trimStartMs, trimEndMs);
-        if (trimmedPcm.isEmpty()) {
-            setStatusMessage(tr("Ошибка: сегмент %1 не содержит звука после обрезки").arg(segment.displayIndex));
-            LOG_WARN() << "Segment" << segment.displayIndex << "is empty after trimming";
-            return;
-        }
-
-        // Reverse the trimmed segment
-        QByteArray reversedSegment = AudioBuffer::reverseSamples(trimmedPcm, segFormat);
-        if (reversedSegment.isEmpty()) {
-            setStatusMessage(tr("Ошибка: не удалось перевернуть сегмент %1").arg(segment.displayIndex));
-            LOG_WARN() << "Failed to reverse segment" << segment.displayIndex;
-            return;
-        }
-
-        reversedPcm.append(reversedSegment);
-        LOG_INFO() << "Added reversed segment" << segment.displayIndex 
-                   << "to reversed song, original size:" << pcm.size() 
-                   << "trimmed size:" << trimmedPcm.size()
-                   << "reversed size:" << reversedSegment.size();
-    }
-
-    // Save reversed song
-    const QString reversePath = PathUtils::composeReverseSongFile(resultsDir, m_project.projectName());
-    if (!WavUtils::writeWavFile(reversePath, format, reversedPcm, &error)) {
-        setStatusMessage(tr("Ошибка сохранения реверса: %1").arg(error));
-        LOG_WARN() << "Failed to write reversed song:" << error;
-        return;
-    }
+    setStatusMessage(tr("Склейка сегментов..."));
+    LOG_INFO() << "Glue segments requested";
 
-    m_reversedSongPath = reversePath;
-    setStatusMessage(tr("Сегменты склеены: %1, реверс: %2").arg(songPath).arg(reversePath));
-    LOG_INFO() << "Segments glued successfully. Normal:" << songPath << "Reversed:" << reversePath;
-    emit saveStateChanged(); // Update save button state
-    emit reverseStateChanged(); // Update reverse playback button state
+    // Only the trim of each segment is computed; song and reverse are edit lists
+    // over the recordings, rendered while playing or when saving results
+    startEditListBuild(true);
 }
 
 void AppController::toggleGluePlayback()
@@ -1356,7 +1269,7 @@ void AppController::toggleGluePlayback()
         return;
     }
 
-    if (m_project.decodedFilePath().isEmpty() || !QFileInfo::exists(m_project.decodedFilePath())) {
+    if (!songReady()) {
         setStatusMessage(tr("Сначала склейте сегменты"));
         LOG_WARN() << "Glued song file not found";
         return;
@@ -1370,7 +1283,9 @@ void AppController::toggleGluePlayback()
     m_activeReversePlayback.clear();
     m_reversePlaybackActive = false;
 
-    if (m_playback->playFile(m_project.decodedFilePath())) {
+    const bool started = m_project.songEdits().isEmpty() ? m_playback->playFile(m_project.decodedFilePath())
+                                                         : m_playback->playEditList(m_project.songEdits());
+    if (started) {
         m_gluePlaybackActive = true;
         emit glueStateChanged();
         emit reverseStateChanged();
@@ -1395,7 +1310,7 @@ void AppController::toggleSongReversePlayback()
         return;
     }
 
-    if (m_reversedSongPath.isEmpty() || !QFileInfo::exists(m_reversedSongPath)) {
+    if (!reverseReady()) {
         setStatusMessage(tr("Сначала создайте реверс песни"));
         LOG_WARN() << "Reversed song file not found";
         return;
@@ -1409,7 +1324,9 @@ void AppController::toggleSongReversePlayback()
     m_activeReversePlayback.clear();
     m_gluePlaybackActive = false;
 
-    if (m_playback->playFile(m_reversedSongPath)) {
+    const bool started = m_project.reverseEdits().isEmpty() ? m_playback->playFile(m_reversedSongPath)
+                                                            : m_playback->playEditList(m_project.reverseEdits());
+    if (started) {
         m_reversePlaybackActive = true;
         emit reverseStateChanged();
         emit glueStateChanged();
@@ -1454,6 +1371,30 @@ void AppController::stopCurrentRecording()
     }
 }
 
+void AppController::calibrateLatency()
+{
+    if (m_sourceRecordingActive || !m_activeSegmentRecordings.isEmpty() || m_recorder->isRecording()) {
+        setStatusMessage(tr("Калибровка недоступна во время записи"));
+        return;
+    }
+
+    // Measured against the open standby input, the same path duplex takes use
+    if (!m_recorder->isStandbyActive()) {
+        setStatusMessage(tr("Для калибровки включите «Микрофон наготове»"));
+        return;
+    }
+
+    m_playback->stopAll();
+    clearPlaybackStates();
+    if (!m_duplex->calibrate(segmentRecordingFormat())) {
+        setStatusMessage(tr("Ошибка запуска калибровки задержки"));
+        LOG_WARN() << "Failed to start latency calibration";
+        return;
+    }
+    emit duplexSettingsChanged();
+    setStatusMessage(tr("Калибровка задержки: микрофон должен слышать динамики..."));
+}
+
 void AppController::setStatusMessage(const QString &message)
 {
     m_statusMessage = message;
@@ -1467,6 +1408,21 @@ void AppController::refreshUiStates()
     emit reverseStateChanged();
 }
 
+void AppController::stopProjectActivity()
+{
+    // Edit lists of the replaced project must not land in the new one
+    cancelEditListBuild();
+    m_editsStale = false;
+    // A segment take is finished into its own file, the rest is dropped
+    if (!m_activeSegmentRecordings.isEmpty())
+        toggleSegmentRecording(*m_activeSegmentRecordings.begin());
+    else if (m_duplex->isActive())
+        m_duplex->stop();
+    m_activeSegmentRecordings.clear();
+    m_playback->stopAll();
+    clearPlaybackStates();
+}
+
 void AppController::clearPlaybackStates()
 {
     m_activeOriginalPlayback.clear();
@@ -1510,6 +1466,141 @@ bool AppController::hasAnySegmentRecorded() const
     return false;
 }
 
+QAudioFormat AppController::segmentRecordingFormat() const
+{
+    // Use the same format as original buffer
+    QAudioFormat format = m_project.originalBuffer().format();
+    if (!format.isValid()) {
+        format.setChannelCount(1);
+        format.setSampleRate(44100);
+        format.setSampleSize(16);
+        format.setSampleType(QAudioFormat::SignedInt);
+        format.setCodec(QStringLiteral("audio/pcm"));
+        format.setByteOrder(QAudioFormat::LittleEndian);
+    }
+    return format;
+}
+
+void AppController::updateRecordingStandby()
+{
+    if (!m_recordingStandbyEnabled || !m_projectReady) {
+        m_recorder->setPreRollMs(0);
+        return;
+    }
+    // Segment takes are sung against the original: keep the microphone open in
+    // their format so a take starts at once, with the first syllable in it
+    m_recorder->prepare(segmentRecordingFormat());
+    m_recorder->setPreRollMs(kRecordingPreRollMs);
+}
+
+bool AppController::songReady() const
+{
+    if (!m_project.songEdits().isEmpty())
+        return true;
+    return !m_project.decodedFilePath().isEmpty() && QFileInfo::exists(m_project.decodedFilePath());
+}
+
+bool AppController::reverseReady() const
+{
+    if (!m_project.reverseEdits().isEmpty())
+        return true;
+    return !m_reversedSongPath.isEmpty() && QFileInfo::exists(m_reversedSongPath);
+}
+
+bool AppController::exportReversedSong(const QString &filePath)
+{
+    if (m_project.reverseEdits().isEmpty()) {
+        if (QFile::copy(m_reversedSongPath, filePath))
+            return true;
+        LOG_WARN() << "Failed to copy reversed song from" << m_reversedSongPath << "to" << filePath;
+        return false;
+    }
+
+    QString error;
+    if (!m_project.reverseEdits().render(filePath, &error)) {
+        LOG_WARN() << "Failed to render reversed song to" << filePath << error;
+        return false;
+    }
+    return true;
+}
+
+void AppController::refreshSongEdits()
+{
+    // A glue still running was started from the old segments and is redone
+    const bool announce = m_editBuildRunning && m_project.songEdits().isEmpty();
+    if (m_project.songEdits().isEmpty() && !m_editBuildRunning && !m_editsStale)
+        return;
+    m_editsStale = false;
+
+    if (!hasAllSegmentsRecorded()) {
+        cancelEditListBuild();
+        m_project.clearEdits();
+        LOG_WARN() << "Glued song dropped after segment change";
+        emit saveStateChanged();
+        emit reverseStateChanged();
+        return;
+    }
+    // Rebuilding only re-reads the trims of the segments, nothing is rewritten
+    startEditListBuild(announce);
+}
+
+void AppController::startEditListBuild(bool announce)
+{
+    const quint64 generation = ++m_editGeneration;
+    const QVector<SegmentInfo> segments = m_project.segments();
+    const double noiseThreshold = m_segmentNoiseThreshold;
+    GlueEngine *glue = m_glue;
+    if (!m_editBuildRunning) {
+        m_editBuildRunning = true;
+        emit glueStateChanged();
+    }
+
+    m_editPool.start([this, glue, segments, noiseThreshold, generation, announce]() {
+        EditList song;
+        EditList reverse;
+        QString error;
+        const bool built = glue->buildEditLists(segments, noiseThreshold, song, reverse, &error);
+        QMetaObject::invokeMethod(this, [this, generation, announce, built, error, song, reverse]() {
+            finishEditListBuild(generation, announce, built, error, song, reverse);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AppController::cancelEditListBuild()
+{
+    ++m_editGeneration;
+    if (m_editBuildRunning) {
+        m_editBuildRunning = false;
+        emit glueStateChanged();
+    }
+}
+
+void AppController::finishEditListBuild(quint64 generation, bool announce, bool built, const QString &error,
+                                        const EditList &song, const EditList &reverse)
+{
+    if (generation != m_editGeneration) {
+        LOG_INFO() << "Dropping superseded edit list build";
+        return;
+    }
+    m_editBuildRunning = false;
+
+    if (built) {
+        m_project.songEdits() = song;
+        m_project.reverseEdits() = reverse;
+        if (announce)
+            setStatusMessage(tr("Сегменты склеены"));
+        LOG_INFO() << "Segments glued successfully," << song.durationMs() << "ms";
+    } else {
+        m_project.clearEdits();
+        if (announce)
+            setStatusMessage(error);
+        LOG_WARN() << "Glue failed:" << error;
+    }
+    emit glueStateChanged();
+    emit saveStateChanged(); // Update save button state
+    emit reverseStateChanged(); // Update reverse playback button state
+}
+
 SegmentInfo *AppController::segmentByDisplayIndex(int displayIndex)
 {
     auto &segments = m_project.segments();
@@ -1589,6 +1680,51 @@ QVariantList AppController::analyzeVolume(int windowSizeMs, double quietThreshol
     return result;
 }
 
+QVariantList AppController::waveformPeaks(double startMs, double endMs, int binCount,
+                                          double quietThreshold, double loudThreshold) const
+{
+    QVariantList result;
+
+    const WaveformPyramid &waveform = m_project.waveform();
+    if (!m_projectReady || waveform.isEmpty() || binCount <= 0)
+        return result;
+
+    const qint64 sampleRate = waveform.sampleRate();
+    if (sampleRate <= 0)
+        return result;
+
+    const qint64 startFrame = static_cast<qint64>((qMax(0.0, startMs) * sampleRate) / 1000.0);
+    const qint64 endFrame = endMs < 0 ? waveform.frameCount()
+                                      : static_cast<qint64>((endMs * sampleRate) / 1000.0);
+    const QVector<WaveformBin> bins = waveform.summarize(startFrame, endFrame, binCount);
+    if (bins.isEmpty())
+        return result;
+
+    const qint64 clampedStart = qBound<qint64>(0, startFrame, waveform.frameCount());
+    const qint64 rangeFrames = qBound<qint64>(0, endFrame, waveform.frameCount()) - clampedStart;
+    result.reserve(bins.size());
+    for (int i = 0; i < bins.size(); ++i) {
+        const WaveformBin &bin = bins[i];
+        const qint64 binStart = clampedStart + (rangeFrames * i) / bins.size();
+        const qint64 binEnd = clampedStart + (rangeFrames * (i + 1)) / bins.size();
+        const double rms = bin.rmsLevel();
+
+        QVariantMap levelMap;
+        levelMap["startMs"] = (binStart * 1000) / sampleRate;
+        levelMap["endMs"] = (binEnd * 1000) / sampleRate;
+        levelMap["startFrame"] = binStart;
+        levelMap["frameCount"] = binEnd - binStart;
+        levelMap["rmsLevel"] = rms;
+        levelMap["peakLevel"] = bin.peakLevel();
+        levelMap["minLevel"] = bin.minLevel;
+        levelMap["maxLevel"] = bin.maxLevel;
+        levelMap["isQuiet"] = rms < quietThreshold;
+        levelMap["isLoud"] = rms > loudThreshold;
+        result.append(levelMap);
+    }
+    return result;
+}
+
 QVariantList AppController::getSegmentDataForWaveform()
 {
     QVariantList result;
@@ -1638,30 +1774,24 @@ QVariantList AppController::analyzeSegmentRecording(int segmentIndex, int window
         return result;
     }
     
-    // Load the recording file
-    QByteArray pcmData;
-    QAudioFormat format;
+    // Window levels are measured once per recording and cached; only the
+    // classification below depends on the threshold
     QString error;
-    if (!WavUtils::readWavFile(segment->recordingPath, pcmData, format, &error)) {
+    const PcmCache::ProfilePtr profile = m_pcmCache.profile(segment->recordingPath, windowSizeMs, &error);
+    if (!profile) {
         LOG_WARN() << "Failed to read segment recording file:" << segment->recordingPath << "error:" << error;
         return result;
     }
     
-    // Create AudioBuffer from loaded data
-    AudioBuffer buffer;
-    buffer.setFormat(format);
-    buffer.data() = pcmData;
-    
-    if (buffer.frameCount() == 0) {
+    if (profile->totalFrames == 0 || profile->sampleRate <= 0) {
         LOG_WARN() << "Segment recording buffer is empty";
         return result;
     }
     
     // Analyze volume using segment noise threshold
-    const QVector<VolumeLevel> levels = VolumeAnalyzer::analyzeVolume(
-        buffer, windowSizeMs, m_segmentNoiseThreshold, 0.7);
+    const QVector<VolumeLevel> levels = VolumeAnalyzer::classify(*profile, m_segmentNoiseThreshold, 0.7);
     
-    const qint64 sampleRate = format.sampleRate();
+    const qint64 sampleRate = profile->sampleRate;
     
     // Convert to QVariantList for QML
     for (const VolumeLevel &level : levels) {
@@ -1725,109 +1855,20 @@ double AppController::getSegmentRecordingTrimmedStartMs(int segmentIndex)
         return 0.0;
     }
     
-    // Load the recording file
-    QByteArray pcm;
-    QAudioFormat format;
+    // Cached window levels of the recording, independent of the threshold
     QString error;
-    if (!WavUtils::readWavFile(segment->recordingPath, pcm, format, &error)) {
+    const PcmCache::ProfilePtr profile = m_pcmCache.profile(segment->recordingPath, 100, &error);
+    if (!profile) {
         LOG_WARN() << "Failed to read segment recording for trimmed start calculation:" << segment->recordingPath << error;
         return 0.0;
     }
     
-    // Create AudioBuffer from loaded data
-    AudioBuffer buffer;
-    buffer.setFormat(format);
-    buffer.data() = pcm;
-    
-    if (buffer.frameCount() == 0) {
-        return 0.0;
-    }
-    
-    const qint64 sampleRate = format.sampleRate();
-    if (sampleRate <= 0) {
-        return 0.0;
-    }
-    
-    // Analyze volume to find where trimming starts
-    const QVector<VolumeLevel> levels = VolumeAnalyzer::analyzeVolume(
-        buffer, 100, m_segmentNoiseThreshold, 0.7);
-    
-    if (levels.isEmpty()) {
+    if (profile->totalFrames == 0 || profile->sampleRate <= 0) {
         return 0.0;
     }
     
-    // Find start of real sound (first loud section)
-    qint64 startFrame = 0;
-    for (int i = 0; i < levels.size(); ++i) {
-        const VolumeLevel &level = levels[i];
-        if (!level.isQuiet) {
-            // Found first loud section - this is where trimming starts
-            startFrame = level.startFrame;
-            break;
-        }
-    }
-    
-    // Convert frames to milliseconds
-    return (startFrame * 1000.0) / sampleRate;
-}
-
-// Helper function to calculate trim boundaries for a segment recording
-static QPair<double, double> calculateTrimBoundaries(const QByteArray &pcm, const QAudioFormat &format, double noiseThreshold)
-{
-    QPair<double, double> result(-1.0, -1.0);
-    
-    if (pcm.isEmpty() || !format.isValid()) {
-        return result;
-    }
-    
-    AudioBuffer buffer;
-    buffer.setFormat(format);
-    buffer.data() = pcm;
-    
-    if (buffer.frameCount() == 0) {
-        return result;
-    }
-    
-    const qint64 sampleRate = format.sampleRate();
-    if (sampleRate <= 0) {
-        return result;
-    }
-    
-    const QVector<VolumeLevel> levels = VolumeAnalyzer::analyzeVolume(
-        buffer, 100, noiseThreshold, 0.7);
-    
-    if (levels.isEmpty()) {
-        return result;
-    }
-    
-    // Find start of real sound (first loud section)
-    qint64 startFrame = 0;
-    for (int i = 0; i < levels.size(); ++i) {
-        const VolumeLevel &level = levels[i];
-        if (!level.isQuiet) {
-            startFrame = level.startFrame;
-            break;
-        }
-    }
-    
-    // Find end of real sound (last loud section)
-    qint64 endFrame = buffer.frameCount();
-    for (int i = levels.size() - 1; i >= 0; --i) {
-        const VolumeLevel &level = levels[i];
-        if (!level.isQuiet) {
-            endFrame = level.startFrame + level.frameCount;
-            break;
-        }
-    }
-    
-    // Convert to milliseconds
-    double startMs = (startFrame * 1000.0) / sampleRate;
-    double endMs = (endFrame * 1000.0) / sampleRate;
-    
-    result.first = startMs;
-    result.second = endMs;
-    
-    return result;
+    const TrimRange range = SegmentTrimmer(m_segmentNoiseThreshold).detect(*profile);
+    return (range.startFrame * 1000.0) / profile->sampleRate;
 }
 
 QVariantMap AppController::getSegmentTrimBoundaries(int segmentIndex)
@@ -1857,17 +1898,20 @@ QVariantMap AppController::getSegmentTrimBoundaries(int segmentIndex)
     }
     
     // Otherwise, calculate automatic boundaries
-    QByteArray pcm;
-    QAudioFormat format;
     QString error;
-    if (!WavUtils::readWavFile(segment->recordingPath, pcm, format, &error)) {
+    const PcmCache::ProfilePtr profile = m_pcmCache.profile(segment->recordingPath, 100, &error);
+    if (!profile) {
         LOG_WARN() << "Failed to read segment recording for trim boundaries:" << segment->recordingPath << error;
         return result;
     }
     
-    QPair<double, double> boundaries = calculateTrimBoundaries(pcm, format, m_segmentNoiseThreshold);
-    result["trimStartMs"] = boundaries.first;
-    result["trimEndMs"] = boundaries.second;
+    if (profile->totalFrames == 0 || profile->sampleRate <= 0) {
+        return result;
+    }
+    
+    const TrimRange range = SegmentTrimmer(m_segmentNoiseThreshold).detect(*profile);
+    result["trimStartMs"] = (range.startFrame * 1000.0) / profile->sampleRate;
+    result["trimEndMs"] = (range.endFrame * 1000.0) / profile->sampleRate;
     
     return result;
 }
@@ -1897,6 +1941,7 @@ void AppController::setSegmentTrimBoundaries(int segmentIndex, double trimStartM
                << "start:" << trimStartMs << "ms end:" << trimEndMs << "ms";
     
     emit m_project.segmentsUpdated();
+    refreshSongEdits();
 }
 
 void AppController::recreateSegmentsFromBoundaries(const QVariantList &boundariesMs, bool manualBoundaries)
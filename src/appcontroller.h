@@ -1,16 +1,23 @@
 #pragma once
 
 #include "audio/audioproject.h"
+#include "audio/pcmcache.h"
 #include "audio/segmentmodel.h"
 #include "audio/volumeanalyzer.h"
 
 #include <QObject>
 #include <QSet>
+#include <QThreadPool>
 #include <QVariant>
 
+#include <atomic>
+#include <memory>
+
 class AudioFileDecoder;
 class AudioPlaybackEngine;
+class DuplexSession;
 class RecordingEngine;
+class GlueEngine;
 class ProjectSerializer;
 
 class AppController : public QObject
@@ -20,6 +27,8 @@ class AppController : public QObject
     Q_PROPERTY(int segmentLength READ segmentLength NOTIFY segmentLengthChanged)
     Q_PROPERTY(QString statusMessage READ statusMessage NOTIFY statusMessageChanged)
     Q_PROPERTY(bool projectReady READ projectReady NOTIFY projectReadinessChanged)
+    Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
+    Q_PROPERTY(double loadProgress READ loadProgress NOTIFY loadProgressChanged)
     Q_PROPERTY(QString currentSourceName READ currentSourceName NOTIFY currentSourceNameChanged)
     Q_PROPERTY(bool sourceRecording READ sourceRecording NOTIFY sourceRecordingChanged)
     Q_PROPERTY(bool canAdjustSegmentLength READ canAdjustSegmentLength NOTIFY canAdjustSegmentLengthChanged)
@@ -36,6 +45,10 @@ class AppController : public QObject
     Q_PROPERTY(bool recordingDialogVisible READ recordingDialogVisible NOTIFY recordingDialogVisibleChanged)
     Q_PROPERTY(bool recordingReady READ recordingReady NOTIFY recordingReadyChanged)
     Q_PROPERTY(bool originalPlaybackEnabled READ originalPlaybackEnabled WRITE setOriginalPlaybackEnabled NOTIFY originalPlaybackEnabledChanged)
+    Q_PROPERTY(bool recordingStandbyEnabled READ recordingStandbyEnabled WRITE setRecordingStandbyEnabled NOTIFY recordingStandbyEnabledChanged)
+    Q_PROPERTY(bool duplexRecordingEnabled READ duplexRecordingEnabled WRITE setDuplexRecordingEnabled NOTIFY duplexSettingsChanged)
+    Q_PROPERTY(bool latencyCalibrating READ latencyCalibrating NOTIFY duplexSettingsChanged)
+    Q_PROPERTY(double duplexLatencyMs READ duplexLatencyMs NOTIFY duplexSettingsChanged)
     Q_PROPERTY(double originalNoiseThreshold READ originalNoiseThreshold WRITE setOriginalNoiseThreshold NOTIFY volumeSettingsChanged)
     Q_PROPERTY(double segmentNoiseThreshold READ segmentNoiseThreshold WRITE setSegmentNoiseThreshold NOTIFY volumeSettingsChanged)
     Q_PROPERTY(double playbackPositionMs READ playbackPositionMs NOTIFY playbackPositionChanged)
@@ -51,6 +64,8 @@ public:
     int segmentLength() const;
     QString statusMessage() const;
     bool projectReady() const;
+    bool loading() const;
+    double loadProgress() const;
     QString currentSourceName() const;
     bool sourceRecording() const;
     bool canAdjustSegmentLength() const;
@@ -68,6 +83,15 @@ public:
     bool canSaveResults() const;
     bool originalPlaybackEnabled() const;
     void setOriginalPlaybackEnabled(bool enabled);
+    // Microphone kept open between segment takes of a loaded project, so a
+    // take starts at once with a short pre-roll; off by default
+    bool recordingStandbyEnabled() const;
+    void setRecordingStandbyEnabled(bool enabled);
+    // Segment takes are recorded while the reversed original plays
+    bool duplexRecordingEnabled() const;
+    void setDuplexRecordingEnabled(bool enabled);
+    bool latencyCalibrating() const;
+    double duplexLatencyMs() const;
     
     double originalNoiseThreshold() const;
     void setOriginalNoiseThreshold(double threshold);
@@ -75,6 +99,9 @@ public:
     void setSegmentNoiseThreshold(double threshold);
     
     double playbackPositionMs() const;
+    // Playhead clock for per-frame sampling from QML, see AudioPlaybackEngine
+    Q_INVOKABLE double playbackClockMs() const;
+    Q_INVOKABLE double playbackLatencyMs() const;
     int activePlaybackSegmentIndex() const;
     bool isPlayingOriginalSegment() const;
 
@@ -102,10 +129,18 @@ public:
 
     Q_INVOKABLE void saveProject();
     Q_INVOKABLE void stopCurrentRecording();
+    // Measures the speaker-to-microphone latency duplex takes are shifted by
+    Q_INVOKABLE void calibrateLatency();
     
     // Analyze volume levels in the audio
     // Returns a list of objects with: startMs, endMs, rmsLevel, peakLevel, isQuiet, isLoud
     Q_INVOKABLE QVariantList analyzeVolume(int windowSizeMs = 100, double quietThreshold = 0.1, double loudThreshold = 0.7);
+
+    // Summarize [startMs, endMs) of the original audio into binCount columns from the
+    // precomputed waveform pyramid; endMs < 0 means up to the end of the audio.
+    // Returns the same objects as analyzeVolume, one per column
+    Q_INVOKABLE QVariantList waveformPeaks(double startMs, double endMs, int binCount,
+                                           double quietThreshold = 0.1, double loudThreshold = 0.7) const;
     
     // Get segment data for waveform visualization
     // Returns a list of objects with: startMs, endMs, index
@@ -126,6 +161,8 @@ signals:
     void segmentLengthChanged();
     void statusMessageChanged();
     void projectReadinessChanged();
+    void loadingChanged();
+    void loadProgressChanged();
     void currentSourceNameChanged();
     void sourceRecordingChanged();
     void canAdjustSegmentLengthChanged();
@@ -138,16 +175,45 @@ signals:
     void sourceTypeChanged();
     void saveStateChanged();
     void originalPlaybackEnabledChanged();
+    void recordingStandbyEnabledChanged();
+    void duplexSettingsChanged();
     void volumeSettingsChanged();
     void playbackPositionChanged();
 
 private:
     void setStatusMessage(const QString &message);
+    void cancelAudioSourceLoad();
+    void setLoadProgress(double progress);
+    // Shows the segments decoded so far while the rest of the source loads
+    void publishPartialLoad(quint64 generation, const AudioBuffer &prefix, const QVector<SegmentInfo> &segments);
+    // Puts back the project replaced by partial load results
+    void restoreLoadBackup();
+    void finishAudioSourceLoad(quint64 generation, const QString &filePath, bool decoded, const QString &error,
+                               const AudioBuffer &buffer, const QVector<SegmentInfo> &segments,
+                               const WaveformPyramid &waveform);
     void refreshUiStates();
+    // Stops playback and any segment take before the project is replaced
+    void stopProjectActivity();
     void clearPlaybackStates();
     void ensureProjectNameFromSource(const QString &sourcePath);
     bool hasAllSegmentsRecorded() const;
     bool hasAnySegmentRecorded() const;
+    QAudioFormat segmentRecordingFormat() const;
+    // Hot standby for segment takes while enabled and a project is ready,
+    // microphone closed otherwise
+    void updateRecordingStandby();
+    // Glued song / reverse available, either as edit lists or as files
+    bool songReady() const;
+    bool reverseReady() const;
+    bool exportReversedSong(const QString &filePath);
+    // Keeps existing edit lists in step with the segment recordings and trims
+    void refreshSongEdits();
+    // Builds song and reverse edit lists on m_editPool; announce reports the
+    // outcome in the status line
+    void startEditListBuild(bool announce);
+    void cancelEditListBuild();
+    void finishEditListBuild(quint64 generation, bool announce, bool built, const QString &error,
+                             const EditList &song, const EditList &reverse);
     SegmentInfo *segmentByDisplayIndex(int displayIndex);
     const SegmentInfo *segmentByDisplayIndex(int displayIndex) const;
 
@@ -157,8 +223,43 @@ private:
     AudioFileDecoder *m_decoder;
     AudioPlaybackEngine *m_playback;
     RecordingEngine *m_recorder;
+    DuplexSession *m_duplex;
+    GlueEngine *m_glue;
     ProjectSerializer *m_serializer;
 
+    // Decoded segment recordings shared by playback, trim queries and glue
+    PcmCache m_pcmCache;
+
+    // Background decode → split pipeline for loadAudioSource().
+    // Each request gets a new generation; results of older generations are dropped.
+    QThreadPool m_loadPool;
+    std::shared_ptr<std::atomic<bool>> m_loadCancelFlag;
+    quint64 m_loadGeneration = 0;
+    bool m_loading = false;
+    double m_loadProgress = 0.0;
+
+    // Project as it was before the first partial result of a load replaced
+    // it; restored if that load fails or is abandoned
+    struct LoadBackup
+    {
+        bool valid = false;
+        bool projectReady = false;
+        AudioBuffer buffer;
+        WaveformPyramid waveform;
+        QVector<SegmentInfo> segments;
+        EditList songEdits;
+        EditList reverseEdits;
+    };
+    LoadBackup m_loadBackup;
+
+    // Edit list builds read every segment recording, so they run off the GUI
+    // thread, one at a time; a newer build or a project change drops the result
+    QThreadPool m_editPool;
+    quint64 m_editGeneration = 0;
+    bool m_editBuildRunning = false;
+    // Edit lists dropped for a segment take, rebuilt once it is recorded
+    bool m_editsStale = false;
+
     QString m_statusMessage;
     QString m_currentSourceName;
     QString m_reversedSongPath;
@@ -169,6 +270,8 @@ private:
     bool m_recordingDialogVisible = false;
     bool m_recordingReady = false;
     bool m_originalPlaybackEnabled = false;
+    bool m_recordingStandbyEnabled = false;
+    bool m_duplexRecordingEnabled = false;
     
     // Noise threshold settings (0.0 to 1.0, RMS level)
     double m_originalNoiseThreshold = 0.1;  // Default: 10% RMS
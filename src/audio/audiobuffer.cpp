@@ -1,7 +1,14 @@
 #include "audiobuffer.h"
 
 #include <QtGlobal>
+#include <algorithm>
 #include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VUD_REVERSE_SSE2 1
+#include <emmintrin.h>
+#endif
 
 namespace {
 qint64 bytesPerSample(const QAudioFormat &format)
@@ -21,11 +28,96 @@ qint64 bytesPerFrame(const QAudioFormat &format)
         return 0;
     return sampleBytes * format.channelCount();
 }
+
+#ifdef VUD_REVERSE_SSE2
+// Reverses the order of the FrameBytes-sized lanes of a 16-byte vector
+template <int FrameBytes>
+__m128i reverseLanes(__m128i v);
+
+template <>
+__m128i reverseLanes<2>(__m128i v)
+{
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+template <>
+__m128i reverseLanes<4>(__m128i v)
+{
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+template <>
+__m128i reverseLanes<8>(__m128i v)
+{
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+}
+#endif
+
+// dst receives the frames of src in reverse order. src is read backwards and
+// dst written forwards, 16 bytes at a time, so both stay sequential streams.
+template <int FrameBytes>
+void reverseCopyFixed(const char *src, char *dst, qint64 frameCount)
+{
+    const qint64 totalBytes = frameCount * FrameBytes;
+    qint64 done = 0;
+#ifdef VUD_REVERSE_SSE2
+    for (; done + 16 <= totalBytes; done += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + totalBytes - done - 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + done), reverseLanes<FrameBytes>(v));
+    }
+#endif
+    // Fixed-size memcpy compiles to a single load/store
+    for (; done < totalBytes; done += FrameBytes)
+        memcpy(dst + done, src + totalBytes - done - FrameBytes, FrameBytes);
+}
+
+// Swaps reversed 16-byte blocks from both ends towards the middle
+template <int FrameBytes>
+void reverseInPlaceFixed(char *data, qint64 frameCount)
+{
+    char *front = data;
+    char *back = data + frameCount * FrameBytes;
+#ifdef VUD_REVERSE_SSE2
+    while (back - front >= 32) {
+        back -= 16;
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(front));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(back));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(front), reverseLanes<FrameBytes>(tail));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(back), reverseLanes<FrameBytes>(head));
+        front += 16;
+    }
+#endif
+    while (back - front >= 2 * FrameBytes) {
+        back -= FrameBytes;
+        char frame[FrameBytes];
+        memcpy(frame, front, FrameBytes);
+        memcpy(front, back, FrameBytes);
+        memcpy(back, frame, FrameBytes);
+        front += FrameBytes;
+    }
+}
+
+// Any other frame size (24-bit, multichannel): one frame at a time
+void reverseCopyGeneric(const char *src, char *dst, qint64 frameCount, qint64 frameBytes)
+{
+    for (qint64 i = 0; i < frameCount; ++i)
+        memcpy(dst + i * frameBytes, src + (frameCount - 1 - i) * frameBytes, static_cast<size_t>(frameBytes));
+}
+
+void reverseInPlaceGeneric(char *data, qint64 frameCount, qint64 frameBytes)
+{
+    for (qint64 i = 0, j = frameCount - 1; i < j; ++i, --j)
+        std::swap_ranges(data + i * frameBytes, data + (i + 1) * frameBytes, data + j * frameBytes);
+}
 }
 
 void AudioBuffer::clear()
 {
-    m_data.clear();
+    m_pages.clear();
+    m_pageOffsets.clear();
+    m_byteCount = 0;
     m_format = QAudioFormat();
 }
 
@@ -39,14 +131,138 @@ const QAudioFormat &AudioBuffer::format() const
     return m_format;
 }
 
-QByteArray &AudioBuffer::data()
+qint64 AudioBuffer::byteCount() const
+{
+    return m_byteCount;
+}
+
+void AudioBuffer::setData(const QByteArray &pcm)
+{
+    m_pages.clear();
+    m_pageOffsets.clear();
+    m_byteCount = 0;
+    if (pcm.isEmpty())
+        return;
+    m_pages.append(pcm);
+    m_pageOffsets.append(0);
+    m_byteCount = pcm.size();
+}
+
+void AudioBuffer::append(const char *pcm, qint64 size)
+{
+    while (size > 0) {
+        qint64 granted = 0;
+        char *dst = appendSpace(size, &granted);
+        memcpy(dst, pcm, static_cast<size_t>(granted));
+        pcm += granted;
+        size -= granted;
+    }
+}
+
+void AudioBuffer::append(const QByteArray &pcm)
 {
-    return m_data;
+    append(pcm.constData(), pcm.size());
 }
 
-const QByteArray &AudioBuffer::data() const
+void AudioBuffer::appendPage(const QByteArray &pcm)
 {
-    return m_data;
+    if (pcm.isEmpty())
+        return;
+    m_pages.append(pcm);
+    m_pageOffsets.append(m_byteCount);
+    m_byteCount += pcm.size();
+}
+
+char *AudioBuffer::appendSpace(qint64 wanted, qint64 *granted)
+{
+    const qint64 capacity = pageBytes();
+    if (m_pages.isEmpty() || m_pages.last().size() >= capacity) {
+        // Reserved up front, so growing a page never moves it
+        QByteArray page;
+        page.reserve(static_cast<int>(capacity));
+        m_pages.append(page);
+        m_pageOffsets.append(m_byteCount);
+    }
+
+    QByteArray &page = m_pages.last();
+    const int oldSize = page.size();
+    const qint64 grow = qMin(wanted, capacity - oldSize);
+    page.resize(oldSize + static_cast<int>(grow));
+    m_byteCount += grow;
+    *granted = grow;
+    return page.data() + oldSize;
+}
+
+void AudioBuffer::truncate(qint64 byteCount)
+{
+    if (byteCount >= m_byteCount)
+        return;
+    if (byteCount <= 0) {
+        m_pages.clear();
+        m_pageOffsets.clear();
+        m_byteCount = 0;
+        return;
+    }
+
+    const int last = pageIndex(byteCount - 1);
+    m_pages.resize(last + 1);
+    m_pageOffsets.resize(last + 1);
+    m_pages[last].resize(static_cast<int>(byteCount - m_pageOffsets[last]));
+    m_byteCount = byteCount;
+}
+
+const char *AudioBuffer::constData(qint64 byteOffset, qint64 *available) const
+{
+    if (byteOffset < 0 || byteOffset >= m_byteCount) {
+        *available = 0;
+        return nullptr;
+    }
+    const int index = pageIndex(byteOffset);
+    const qint64 offsetInPage = byteOffset - m_pageOffsets[index];
+    *available = m_pages[index].size() - offsetInPage;
+    return m_pages[index].constData() + offsetInPage;
+}
+
+qint64 AudioBuffer::read(qint64 byteOffset, char *dst, qint64 length) const
+{
+    qint64 done = 0;
+    while (done < length) {
+        qint64 available = 0;
+        const char *src = constData(byteOffset + done, &available);
+        if (!src)
+            break;
+        const qint64 chunk = qMin(available, length - done);
+        memcpy(dst + done, src, static_cast<size_t>(chunk));
+        done += chunk;
+    }
+    return done;
+}
+
+const char *AudioBuffer::frames(qint64 startFrame, qint64 frameCount, QByteArray &scratch) const
+{
+    const qint64 frameBytes = bytesPerFrame(m_format);
+    const qint64 startByte = startFrame * frameBytes;
+    const qint64 length = frameCount * frameBytes;
+    qint64 available = 0;
+    const char *direct = constData(startByte, &available);
+    if (!direct || available >= length)
+        return direct;
+
+    scratch.resize(static_cast<int>(length));
+    read(startByte, scratch.data(), length);
+    return scratch.constData();
+}
+
+QByteArray AudioBuffer::toByteArray() const
+{
+    if (m_pages.size() == 1)
+        return m_pages.first();
+    if (m_byteCount > std::numeric_limits<int>::max())
+        return {};
+
+    QByteArray pcm(static_cast<int>(m_byteCount), Qt::Uninitialized);
+    read(0, pcm.data(), m_byteCount);
+    return pcm;
 }
 
 qint64 AudioBuffer::sampleCount() const
@@ -54,7 +270,7 @@ qint64 AudioBuffer::sampleCount() const
     const qint64 sampleBytes = bytesPerSample(m_format);
     if (sampleBytes <= 0)
         return 0;
-    return m_data.size() / sampleBytes;
+    return m_byteCount / sampleBytes;
 }
 
 qint64 AudioBuffer::frameCount() const
@@ -62,7 +278,7 @@ qint64 AudioBuffer::frameCount() const
     const qint64 frameBytes = bytesPerFrame(m_format);
     if (frameBytes <= 0)
         return 0;
-    return m_data.size() / frameBytes;
+    return m_byteCount / frameBytes;
 }
 
 qint64 AudioBuffer::durationMs() const
@@ -73,6 +289,11 @@ qint64 AudioBuffer::durationMs() const
     return static_cast<qint64>(seconds * 1000.0);
 }
 
+AudioView AudioBuffer::view(qint64 startFrame, qint64 frameCount) const
+{
+    return AudioView(*this, startFrame, frameCount);
+}
+
 QByteArray AudioBuffer::sliceSamples(qint64 startSample, qint64 sampleCount) const
 {
     const qint64 sampleBytes = bytesPerSample(m_format);
@@ -83,8 +304,12 @@ QByteArray AudioBuffer::sliceSamples(qint64 startSample, qint64 sampleCount) con
         return {};
 
     const qint64 availableSamples = qMin(sampleCount, totalSamples - startSample);
-    const qint64 startByte = startSample * sampleBytes;
-    return QByteArray(m_data.constData() + startByte, static_cast<int>(availableSamples * sampleBytes));
+    const qint64 bytes = availableSamples * sampleBytes;
+    if (bytes > std::numeric_limits<int>::max())
+        return {};
+    QByteArray slice(static_cast<int>(bytes), Qt::Uninitialized);
+    read(startSample * sampleBytes, slice.data(), bytes);
+    return slice;
 }
 
 QByteArray AudioBuffer::sliceFrames(qint64 startFrame, qint64 frameCount) const
@@ -98,8 +323,25 @@ QByteArray AudioBuffer::sliceFrames(qint64 startFrame, qint64 frameCount) const
         return {};
 
     const qint64 availableFrames = qMin(frameCount, totalFrames - startFrame);
-    const qint64 startByte = startFrame * frameBytes;
-    return QByteArray(m_data.constData() + startByte, static_cast<int>(availableFrames * frameBytes));
+    const qint64 bytes = availableFrames * frameBytes;
+    if (bytes > std::numeric_limits<int>::max())
+        return {};
+    QByteArray slice(static_cast<int>(bytes), Qt::Uninitialized);
+    read(startFrame * frameBytes, slice.data(), bytes);
+    return slice;
+}
+
+int AudioBuffer::pageIndex(qint64 byteOffset) const
+{
+    // Last page starting at or before byteOffset
+    const auto it = std::upper_bound(m_pageOffsets.cbegin(), m_pageOffsets.cend(), byteOffset);
+    return static_cast<int>(it - m_pageOffsets.cbegin()) - 1;
+}
+
+qint64 AudioBuffer::pageBytes() const
+{
+    const qint64 frameBytes = qMax<qint64>(1, bytesPerFrame(m_format));
+    return qMax<qint64>(1, kPageBytes / frameBytes) * frameBytes;
 }
 
 QByteArray AudioBuffer::reverseSamples(const QByteArray &pcm, const QAudioFormat &format)
@@ -112,10 +354,138 @@ QByteArray AudioBuffer::reverseSamples(const QByteArray &pcm, const QAudioFormat
     const char *src = pcm.constData();
     char *dst = reversed.data();
     const qint64 frameCount = pcm.size() / frameBytes;
-    for (qint64 i = 0; i < frameCount; ++i) {
-        const char *frameStart = src + (frameCount - 1 - i) * frameBytes;
-        memcpy(dst + i * frameBytes, frameStart, frameBytes);
-    }
+    reverseFrames(src, dst, frameCount, format);
+    // A trailing partial frame is kept as is, at the end
+    const qint64 tailBytes = pcm.size() - frameCount * frameBytes;
+    if (tailBytes > 0)
+        memcpy(dst + frameCount * frameBytes, src + frameCount * frameBytes, static_cast<size_t>(tailBytes));
     return reversed;
 }
 
+void AudioBuffer::reverseFrames(const char *src, char *dst, qint64 frameCount, const QAudioFormat &format)
+{
+    const qint64 frameBytes = bytesPerFrame(format);
+    if (frameBytes <= 0 || frameCount <= 0)
+        return;
+
+    switch (frameBytes) {
+    case 2:
+        reverseCopyFixed<2>(src, dst, frameCount);
+        break;
+    case 4:
+        reverseCopyFixed<4>(src, dst, frameCount);
+        break;
+    case 8:
+        reverseCopyFixed<8>(src, dst, frameCount);
+        break;
+    default:
+        reverseCopyGeneric(src, dst, frameCount, frameBytes);
+        break;
+    }
+}
+
+bool AudioBuffer::reverseSamplesInPlace(QByteArray &pcm, const QAudioFormat &format)
+{
+    const qint64 frameBytes = bytesPerFrame(format);
+    if (frameBytes <= 0)
+        return false;
+
+    char *data = pcm.data();
+    const qint64 frameCount = pcm.size() / frameBytes;
+    switch (frameBytes) {
+    case 2:
+        reverseInPlaceFixed<2>(data, frameCount);
+        break;
+    case 4:
+        reverseInPlaceFixed<4>(data, frameCount);
+        break;
+    case 8:
+        reverseInPlaceFixed<8>(data, frameCount);
+        break;
+    default:
+        reverseInPlaceGeneric(data, frameCount, frameBytes);
+        break;
+    }
+    return true;
+}
+
+AudioView::AudioView(const AudioBuffer &buffer)
+    : AudioView(buffer, 0, buffer.frameCount())
+{
+}
+
+AudioView::AudioView(const AudioBuffer &buffer, qint64 startFrame, qint64 frameCount)
+    : m_buffer(buffer)
+    , m_frameBytes(bytesPerFrame(buffer.format()))
+{
+    const qint64 totalFrames = buffer.frameCount();
+    if (m_frameBytes > 0 && startFrame >= 0 && startFrame < totalFrames && frameCount > 0) {
+        m_startFrame = startFrame;
+        m_frameCount = qMin(frameCount, totalFrames - startFrame);
+    }
+}
+
+bool AudioView::isEmpty() const
+{
+    return m_frameCount <= 0;
+}
+
+const QAudioFormat &AudioView::format() const
+{
+    return m_buffer.format();
+}
+
+qint64 AudioView::startFrame() const
+{
+    return m_startFrame;
+}
+
+qint64 AudioView::frameCount() const
+{
+    return m_frameCount;
+}
+
+qint64 AudioView::byteCount() const
+{
+    return m_frameCount * m_frameBytes;
+}
+
+qint64 AudioView::durationMs() const
+{
+    const int sampleRate = m_buffer.format().sampleRate();
+    if (sampleRate <= 0)
+        return 0;
+    return m_frameCount * 1000 / sampleRate;
+}
+
+const char *AudioView::constData(qint64 byteOffset, qint64 *available) const
+{
+    const qint64 size = byteCount();
+    if (byteOffset < 0 || byteOffset >= size) {
+        *available = 0;
+        return nullptr;
+    }
+    const char *data = m_buffer.constData(m_startFrame * m_frameBytes + byteOffset, available);
+    *available = qMin(*available, size - byteOffset);
+    return data;
+}
+
+qint64 AudioView::read(qint64 byteOffset, char *dst, qint64 length) const
+{
+    if (byteOffset < 0)
+        return 0;
+    length = qMin(length, byteCount() - byteOffset);
+    if (length <= 0)
+        return 0;
+    return m_buffer.read(m_startFrame * m_frameBytes + byteOffset, dst, length);
+}
+
+const char *AudioView::frames(qint64 startFrame, qint64 frameCount, QByteArray &scratch) const
+{
+    return m_buffer.frames(m_startFrame + startFrame, frameCount, scratch);
+}
+
+QByteArray AudioView::toByteArray() const
+{
+    return m_buffer.sliceFrames(m_startFrame, m_frameCount);
+}
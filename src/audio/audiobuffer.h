@@ -4,29 +4,103 @@
 #include <QByteArray>
 #include <QVector>
 
+class AudioView;
+
+// PCM of arbitrary length, stored as a table of pages of about kPageBytes
+// (whole frames each) and indexed with 64-bit offsets. No single allocation
+// has to hold the whole track, and copies share the pages.
 class AudioBuffer
 {
 public:
+    static constexpr qint64 kPageBytes = 1024 * 1024;
+
     AudioBuffer() = default;
 
     void clear();
+    // Set before appending PCM, pages are sized to whole frames of format
     void setFormat(const QAudioFormat &format);
     const QAudioFormat &format() const;
 
-    QByteArray &data();
-    const QByteArray &data() const;
+    qint64 byteCount() const;
+    // Replaces the PCM; the array is adopted as a single page, without a copy
+    void setData(const QByteArray &pcm);
+    void append(const char *pcm, qint64 size);
+    void append(const QByteArray &pcm);
+    // Adopts pcm (whole frames) as the next page, without a copy; a page over
+    // raw data (QByteArray::fromRawData) is only valid while that data is
+    void appendPage(const QByteArray &pcm);
+    // Up to wanted bytes of writable space at the end, within one page; the
+    // buffer already counts them, *granted receives the amount. Give back the
+    // unused part with truncate().
+    char *appendSpace(qint64 wanted, qint64 *granted);
+    void truncate(qint64 byteCount);
+
+    // Contiguous PCM from byteOffset up to the end of its page, length in *available
+    const char *constData(qint64 byteOffset, qint64 *available) const;
+    // Copies up to length bytes from byteOffset across pages, returns the count
+    qint64 read(qint64 byteOffset, char *dst, qint64 length) const;
+    // The given frames as one contiguous block: inside a page the page itself,
+    // across pages a copy in scratch. frameCount must be within frameCount().
+    const char *frames(qint64 startFrame, qint64 frameCount, QByteArray &scratch) const;
+    // Whole PCM as one array (shared while it is a single page); empty when
+    // it does not fit a QByteArray
+    QByteArray toByteArray() const;
 
     qint64 sampleCount() const;
     qint64 frameCount() const;
     qint64 durationMs() const;
 
+    // Frame range sharing this buffer's pages, clamped to the buffer
+    AudioView view(qint64 startFrame, qint64 frameCount) const;
+    // Copies of a range; prefer view() where a copy is not needed
     QByteArray sliceSamples(qint64 startSample, qint64 sampleCount) const;
     QByteArray sliceFrames(qint64 startFrame, qint64 frameCount) const;
 
+    // Frame order reversal; 2, 4 and 8-byte frames (16-bit mono/stereo, 32-bit
+    // stereo) use SIMD shuffles where available
     static QByteArray reverseSamples(const QByteArray &pcm, const QAudioFormat &format);
+    // Same without a second buffer, for PCM that is not needed in playback order
+    static bool reverseSamplesInPlace(QByteArray &pcm, const QAudioFormat &format);
+    // Writes frameCount frames of src to dst in reverse order (no overlap allowed)
+    static void reverseFrames(const char *src, char *dst, qint64 frameCount, const QAudioFormat &format);
 
 private:
+    int pageIndex(qint64 byteOffset) const;
+    qint64 pageBytes() const;
+
     QAudioFormat m_format;
-    QByteArray m_data;
+    QVector<QByteArray> m_pages;
+    QVector<qint64> m_pageOffsets; // Byte offset of each page in the PCM
+    qint64 m_byteCount = 0;
 };
 
+// Frame range of an AudioBuffer. Holds a shallow copy of the buffer, so the
+// pages stay alive as long as the view, and copying a view allocates nothing.
+// Offsets and frame numbers are relative to the start of the view.
+class AudioView
+{
+public:
+    AudioView() = default;
+    // Whole buffer
+    AudioView(const AudioBuffer &buffer);
+    AudioView(const AudioBuffer &buffer, qint64 startFrame, qint64 frameCount);
+
+    bool isEmpty() const;
+    const QAudioFormat &format() const;
+    qint64 startFrame() const; // Within the underlying buffer
+    qint64 frameCount() const;
+    qint64 byteCount() const;
+    qint64 durationMs() const;
+
+    // Same contracts as the AudioBuffer counterparts, limited to the view
+    const char *constData(qint64 byteOffset, qint64 *available) const;
+    qint64 read(qint64 byteOffset, char *dst, qint64 length) const;
+    const char *frames(qint64 startFrame, qint64 frameCount, QByteArray &scratch) const;
+    QByteArray toByteArray() const;
+
+private:
+    AudioBuffer m_buffer;
+    qint64 m_startFrame = 0;
+    qint64 m_frameCount = 0;
+    qint64 m_frameBytes = 0;
+};
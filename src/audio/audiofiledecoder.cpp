@@ -7,12 +7,16 @@
 #include <QtEndian>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 
 #include "../utils/logger.h"
 #include "wavutils.h"
 
+// SIMD synthesis/IMDCT paths are compiled in: SSE2 on x86 (runtime-checked via
+// cpuid on 32-bit builds, always on for x64) and NEON on ARM. Configure with
+// -DVUD_MINIMP3_NO_SIMD=ON to force the scalar path, e.g. for benchmarking.
 #define MINIMP3_IMPLEMENTATION
-#define MINIMP3_NO_SIMD
+#define MINIMP3_NO_STDIO
 #include "../../thirdparty/minimp3_ex.h"
 
 namespace {
@@ -24,6 +28,107 @@ QString toLocalPath(const QString &path)
     return path;
 }
 
+// Frames decoded per mp3dec_ex_read call; progress is reported after each chunk
+constexpr qint64 kDecodeChunkFrames = 64 * 1024;
+
+QAudioFormat pcm16Format(int channels, int sampleRate)
+{
+    QAudioFormat format;
+    format.setChannelCount(channels);
+    format.setSampleRate(sampleRate);
+    format.setSampleSize(16);
+    format.setCodec(QStringLiteral("audio/pcm"));
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setSampleType(QAudioFormat::SignedInt);
+    return format;
+}
+
+bool failMp3(const QString &localPath, int result, QString *errorString)
+{
+    const QString err = QObject::tr("Не удалось декодировать MP3-файл.");
+    if (errorString)
+        *errorString = err;
+    LOG_WARN() << "Failed to decode MP3:" << localPath << "result" << result;
+    return false;
+}
+
+// Decodes the MP3 frame by frame straight into the AudioBuffer pages. The
+// file is memory-mapped and every chunk is decoded into the free space of the
+// last page, so the track length is bounded by memory, not by QByteArray.
+bool decodeMp3Streaming(const QString &localPath, AudioBuffer &outBuffer, QString *errorString,
+                        const AudioFileDecoder::ProgressCallback &progress)
+{
+    QFile file(localPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return failMp3(localPath, MP3D_E_IOERROR, errorString);
+
+    const qint64 fileSize = file.size();
+    const uchar *mapped = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    if (!mapped)
+        return failMp3(localPath, MP3D_E_IOERROR, errorString);
+
+    // mp3dec_ex_t embeds a full frame of PCM and the decoder state, keep it off the stack
+    std::unique_ptr<mp3dec_ex_t> decoder(new mp3dec_ex_t);
+    int res = mp3dec_ex_open_buf(decoder.get(), mapped, static_cast<size_t>(fileSize), MP3D_SEEK_TO_SAMPLE);
+    if (res != 0 || decoder->info.channels <= 0 || decoder->info.hz <= 0) {
+        mp3dec_ex_close(decoder.get());
+        return failMp3(localPath, res, errorString);
+    }
+
+    const int channels = decoder->info.channels;
+    const qint64 totalSamples = static_cast<qint64>(decoder->samples); // already includes channels
+    const qint64 totalFrames = totalSamples / channels;
+
+    outBuffer.clear();
+    outBuffer.setFormat(pcm16Format(channels, decoder->info.hz));
+
+    const qint64 chunkSamples = kDecodeChunkFrames * channels;
+    qint64 decodedSamples = 0;
+    bool cancelled = false;
+    for (;;) {
+        // Decode directly behind the current end; pages hold whole frames, so
+        // the granted space is always a whole number of frames
+        const qint64 wantedSamples = totalSamples > decodedSamples
+            ? qMin(chunkSamples, totalSamples - decodedSamples)
+            : chunkSamples;
+        const qint64 oldBytes = outBuffer.byteCount();
+        qint64 grantedBytes = 0;
+        auto *dst = reinterpret_cast<mp3d_sample_t *>(
+            outBuffer.appendSpace(wantedSamples * static_cast<qint64>(sizeof(mp3d_sample_t)), &grantedBytes));
+        const qint64 grantedSamples = grantedBytes / static_cast<qint64>(sizeof(mp3d_sample_t));
+        const size_t readSamples = mp3dec_ex_read(decoder.get(), dst, static_cast<size_t>(grantedSamples));
+        outBuffer.truncate(oldBytes + static_cast<qint64>(readSamples * sizeof(mp3d_sample_t)));
+        decodedSamples += static_cast<qint64>(readSamples);
+
+        if (progress && !progress(decodedSamples / channels, qMax(totalFrames, decodedSamples / channels))) {
+            cancelled = true;
+            break;
+        }
+        if (static_cast<qint64>(readSamples) < grantedSamples)
+            break;
+    }
+
+    res = decoder->last_error;
+    mp3dec_ex_close(decoder.get());
+    file.unmap(const_cast<uchar *>(mapped));
+
+    if (cancelled) {
+        outBuffer.clear();
+        if (errorString)
+            *errorString = QObject::tr("Загрузка отменена");
+        LOG_INFO() << "MP3 decoding cancelled:" << localPath;
+        return false;
+    }
+    if (decodedSamples == 0 || (res != 0 && res != MP3D_E_USER)) {
+        outBuffer.clear();
+        return failMp3(localPath, res, errorString);
+    }
+
+    LOG_INFO() << "MP3 decoded successfully:" << localPath << "channels" << channels
+               << "rate" << decoder->info.hz << "frames" << decodedSamples / channels;
+    return true;
+}
+
 } // namespace
 
 AudioFileDecoder::AudioFileDecoder(QObject *parent)
@@ -31,7 +136,19 @@ AudioFileDecoder::AudioFileDecoder(QObject *parent)
 {
 }
 
-bool AudioFileDecoder::decodeFile(const QString &filePath, AudioBuffer &outBuffer, QString *errorString)
+QString AudioFileDecoder::mp3Backend()
+{
+#if defined(MINIMP3_NO_SIMD) || !HAVE_SIMD
+    return QStringLiteral("scalar");
+#elif HAVE_SSE
+    return have_simd() ? QStringLiteral("sse2") : QStringLiteral("scalar");
+#else
+    return QStringLiteral("neon");
+#endif
+}
+
+bool AudioFileDecoder::decodeFile(const QString &filePath, AudioBuffer &outBuffer, QString *errorString,
+                                  const ProgressCallback &progress)
 {
     QString localPath = toLocalPath(filePath);
     QFileInfo info(localPath);
@@ -45,52 +162,26 @@ bool AudioFileDecoder::decodeFile(const QString &filePath, AudioBuffer &outBuffe
 
     const QString ext = info.suffix().toLower();
     if (ext == QStringLiteral("wav")) {
-        QByteArray pcm;
-        QAudioFormat format;
-        if (!WavUtils::readWavFile(localPath, pcm, format, errorString))
+        // Copied page by page out of the mapping, so the PCM may exceed 2 GiB
+        WavUtils::WavFileView view;
+        if (!view.open(localPath, errorString))
             return false;
-        outBuffer.setFormat(format);
-        outBuffer.data() = pcm;
-        return true;
-    }
-
-    if (ext == QStringLiteral("mp3")) {
-        mp3dec_t decoder;
-        mp3dec_file_info_t mp3info;
-        memset(&decoder, 0, sizeof(decoder));
-        memset(&mp3info, 0, sizeof(mp3info));
-        int res = mp3dec_load(&decoder, localPath.toUtf8().constData(), &mp3info, nullptr, nullptr);
-        if (res != 0 || !mp3info.buffer || mp3info.samples == 0 || mp3info.channels <= 0 || mp3info.hz <= 0) {
-            if (mp3info.buffer)
-                free(mp3info.buffer);
-            const QString err = QObject::tr("Не удалось декодировать MP3-файл.");
+        outBuffer.clear();
+        outBuffer.setFormat(view.format());
+        outBuffer.append(view.pcmData(), view.pcmSize());
+        const qint64 frames = outBuffer.frameCount();
+        if (progress && !progress(frames, frames)) {
+            outBuffer.clear();
             if (errorString)
-                *errorString = err;
-            LOG_WARN() << "Failed to decode MP3:" << localPath << "result" << res;
+                *errorString = QObject::tr("Загрузка отменена");
             return false;
         }
-
-        const size_t totalSamples = static_cast<size_t>(mp3info.samples); // already includes channels
-        const size_t totalBytes = totalSamples * sizeof(int16_t);
-        QByteArray pcmData(static_cast<int>(totalBytes), Qt::Uninitialized);
-        memcpy(pcmData.data(), mp3info.buffer, totalBytes);
-
-        QAudioFormat format;
-        format.setChannelCount(mp3info.channels);
-        format.setSampleRate(mp3info.hz);
-        format.setSampleSize(16);
-        format.setCodec(QStringLiteral("audio/pcm"));
-        format.setByteOrder(QAudioFormat::LittleEndian);
-        format.setSampleType(QAudioFormat::SignedInt);
-
-        outBuffer.setFormat(format);
-        outBuffer.data() = pcmData;
-
-        free(mp3info.buffer);
-        LOG_INFO() << "MP3 decoded successfully:" << localPath << "channels" << format.channelCount() << "rate" << format.sampleRate();
         return true;
     }
 
+    if (ext == QStringLiteral("mp3"))
+        return decodeMp3Streaming(localPath, outBuffer, errorString, progress);
+
     const QString err = QObject::tr("Формат файла не поддерживается: %1").arg(ext);
     if (errorString)
         *errorString = err;
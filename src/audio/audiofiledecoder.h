@@ -4,12 +4,27 @@
 
 #include <QObject>
 
+#include <functional>
+
 class AudioFileDecoder : public QObject
 {
     Q_OBJECT
 public:
+    // Invoked on the decoding thread after every decoded chunk, when outBuffer
+    // holds exactly decodedFrames. A copy of outBuffer taken here is an
+    // immutable snapshot of the decoded prefix that may be handed to other
+    // threads: it shares the pages, and decoding detaches the one it writes.
+    // Return false to abort decoding; decodeFile() then fails and clears outBuffer.
+    using ProgressCallback = std::function<bool(qint64 decodedFrames, qint64 totalFrames)>;
+
     explicit AudioFileDecoder(QObject *parent = nullptr);
 
-    bool decodeFile(const QString &filePath, AudioBuffer &outBuffer, QString *errorString = nullptr);
+    // MP3 files are decoded incrementally into outBuffer, page by page, with
+    // every chunk reported through progress.
+    bool decodeFile(const QString &filePath, AudioBuffer &outBuffer, QString *errorString = nullptr,
+                    const ProgressCallback &progress = ProgressCallback());
+
+    // MP3 synthesis path selected at runtime: "sse2", "neon" or "scalar"
+    static QString mp3Backend();
 };
 
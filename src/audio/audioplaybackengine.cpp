@@ -2,36 +2,181 @@
 
 #include <QAudioOutput>
 #include <QAudio>
-#include <QBuffer>
-#include <QFile>
-#include <QScopedPointer>
-#include <QTimer>
 #include <QElapsedTimer>
+#include <QIODevice>
+#include <QMutex>
+#include <QTimer>
+#include <cstring>
 #include <memory>
 
+#include "audiobuffer.h"
+#include "editlist.h"
+#include "reverseaudiodevice.h"
 #include "wavutils.h"
 #include "../utils/logger.h"
 
+namespace {
+
+// Device buffer requested from the backend; a new clip becomes audible after
+// at most this much of already queued audio
+constexpr int kOutputBufferMs = 40;
+
+// Pull-mode source the persistent QAudioOutput reads from. It plays the current
+// clip straight from an AudioView (shared pages, never copied) or from a device
+// that produces it on demand, and outputs silence once the clip is over, so the
+// output keeps running between clips.
+class PlaybackSource : public QIODevice
+{
+public:
+    explicit PlaybackSource(QObject *parent = nullptr)
+        : QIODevice(parent)
+    {
+    }
+
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+    // Starts view at the next read; returns the stream byte offset the clip begins at
+    qint64 setClip(const AudioView &view)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_clip = view;
+        m_clipDevice.reset();
+        m_clipPos = 0;
+        return m_streamBytes;
+    }
+
+    // Same for a clip read from an open device
+    qint64 setClip(std::unique_ptr<QIODevice> device)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_clip = AudioView();
+        m_clipDevice = std::move(device);
+        m_clipPos = 0;
+        return m_streamBytes;
+    }
+
+    void clearClip()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_clip = AudioView();
+        m_clipDevice.reset();
+        m_clipPos = 0;
+    }
+
+    qint64 streamBytes() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_streamBytes;
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override
+    {
+        QMutexLocker locker(&m_mutex);
+        qint64 fromClip = 0;
+        if (m_clipDevice) {
+            fromClip = m_clipDevice->read(data, maxlen);
+        } else {
+            fromClip = m_clip.read(m_clipPos, data, maxlen);
+            m_clipPos += fromClip;
+        }
+        const qint64 silence = maxlen - qMax<qint64>(0, fromClip);
+        if (silence > 0)
+            memset(data + (maxlen - silence), 0, static_cast<size_t>(silence));
+        m_streamBytes += maxlen;
+        return maxlen;
+    }
+
+    qint64 writeData(const char *data, qint64 len) override
+    {
+        Q_UNUSED(data);
+        Q_UNUSED(len);
+        return -1;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    AudioView m_clip;
+    std::unique_ptr<QIODevice> m_clipDevice;
+    qint64 m_clipPos = 0;
+    // Bytes handed to the device since the output was started
+    qint64 m_streamBytes = 0;
+};
+
+bool sameFormat(const QAudioFormat &a, const QAudioFormat &b)
+{
+    return a.sampleRate() == b.sampleRate()
+        && a.channelCount() == b.channelCount()
+        && a.sampleSize() == b.sampleSize()
+        && a.sampleType() == b.sampleType()
+        && a.byteOrder() == b.byteOrder();
+}
+
+double bytesToMs(qint64 bytes, const QAudioFormat &format)
+{
+    const int bytesPerFrame = format.channelCount() * (format.sampleSize() / 8);
+    if (bytesPerFrame <= 0 || format.sampleRate() <= 0)
+        return 0.0;
+    return (bytes / bytesPerFrame) * 1000.0 / format.sampleRate();
+}
+
+} // namespace
+
 class AudioPlaybackEngine::Impl
 {
 public:
+    // Persistent output, reopened only when the clip format changes
     std::unique_ptr<QAudioOutput> output;
-    std::unique_ptr<QBuffer> bufferDevice;
-    std::unique_ptr<QFile> fileDevice;
-    QByteArray bufferData;
+    std::unique_ptr<PlaybackSource> source;
+    QAudioFormat outputFormat;
+    // Keeps the mapping behind the current clip alive while a file is playing
+    std::unique_ptr<WavUtils::WavFileView> fileView;
     bool playing = false;
-    
+
     QAudioFormat format;
     QTimer *positionTimer = nullptr;
-    QElapsedTimer elapsedTimer;
+    // Stream byte offset at which the current clip was handed to the source
+    qint64 clipStartBytes = 0;
     qint64 totalBytes = 0;
     double durationMs = 0.0;
+
+    // Interpolated clock: the last measured position and when it was taken
+    QElapsedTimer clock;
+    double anchorPositionMs = 0.0;
+    qint64 anchorClockNs = 0;
+    mutable double lastClockMs = 0.0;
+
+    // Bytes handed to the source but still waiting in the device buffer
+    qint64 queuedBytes() const
+    {
+        if (!output)
+            return 0;
+        return qMax(0, output->bufferSize() - output->bytesFree());
+    }
+
+    double audiblePositionMs() const
+    {
+        if (!playing || !source)
+            return 0.0;
+        const qint64 audibleBytes = source->streamBytes() - queuedBytes() - clipStartBytes;
+        return qBound(0.0, bytesToMs(audibleBytes, format), durationMs);
+    }
+
+    void anchorClock()
+    {
+        anchorPositionMs = audiblePositionMs();
+        anchorClockNs = clock.nsecsElapsed();
+    }
 };
 
 AudioPlaybackEngine::AudioPlaybackEngine(QObject *parent)
     : QObject(parent)
     , d(new Impl())
 {
+    d->clock.start();
     d->positionTimer = new QTimer(this);
     d->positionTimer->setInterval(50); // Update every 50ms for smooth animation
     connect(d->positionTimer, &QTimer::timeout, this, &AudioPlaybackEngine::updatePlaybackPosition);
@@ -40,9 +185,50 @@ AudioPlaybackEngine::AudioPlaybackEngine(QObject *parent)
 AudioPlaybackEngine::~AudioPlaybackEngine()
 {
     stopAll();
+    if (d->output)
+        d->output->stop();
     delete d;
 }
 
+bool AudioPlaybackEngine::ensureOutput(const QAudioFormat &format)
+{
+    if (d->output && sameFormat(d->outputFormat, format))
+        return true;
+
+    if (d->output) {
+        LOG_INFO() << "Playback format changed, reopening audio output";
+        d->output->stop();
+        d->output.reset();
+    }
+    d->source.reset();
+
+    d->source = std::make_unique<PlaybackSource>();
+    d->source->open(QIODevice::ReadOnly);
+    d->output = std::make_unique<QAudioOutput>(format);
+    d->output->setBufferSize(format.bytesForDuration(kOutputBufferMs * 1000));
+    connect(d->output.get(), &QAudioOutput::stateChanged, this, [this](QAudio::State state) {
+        if (state == QAudio::StoppedState && d->output && d->output->error() != QAudio::NoError) {
+            const QString message = tr("Ошибка воспроизведения: %1").arg(d->output->error());
+            // Drop the broken device, the next clip opens a fresh one
+            QTimer::singleShot(0, this, [this]() {
+                stopAll();
+                d->output.reset();
+                d->source.reset();
+            });
+            emit playbackError(message);
+        }
+    });
+    d->output->start(d->source.get());
+    if (d->output->error() != QAudio::NoError) {
+        LOG_WARN() << "Failed to open audio output:" << d->output->error();
+        d->output.reset();
+        d->source.reset();
+        return false;
+    }
+    d->outputFormat = format;
+    return true;
+}
+
 bool AudioPlaybackEngine::playBuffer(const QByteArray &pcm, const QAudioFormat &format)
 {
     if (!format.isValid() || pcm.isEmpty()) {
@@ -50,74 +236,109 @@ bool AudioPlaybackEngine::playBuffer(const QByteArray &pcm, const QAudioFormat &
         return false;
     }
 
+    // Adopted as a single page, pcm is shared rather than copied
+    AudioBuffer buffer;
+    buffer.setFormat(format);
+    buffer.setData(pcm);
+    return playView(AudioView(buffer));
+}
+
+bool AudioPlaybackEngine::playView(const AudioView &view)
+{
+    if (!view.format().isValid() || view.isEmpty()) {
+        LOG_WARN() << "playView received invalid data";
+        return false;
+    }
+
+    if (!prepareClip(view.format(), view.byteCount()))
+        return false;
+    startClip(d->source->setClip(view));
+    return true;
+}
+
+bool AudioPlaybackEngine::playReverse(const AudioView &view)
+{
+    auto device = std::make_unique<ReverseAudioDevice>(view);
+    if (!view.format().isValid() || device->size() <= 0 || !device->open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        LOG_WARN() << "playReverse received invalid data";
+        return false;
+    }
+
+    if (!prepareClip(view.format(), device->size()))
+        return false;
+    startClip(d->source->setClip(std::move(device)));
+    return true;
+}
+
+bool AudioPlaybackEngine::playEditList(const EditList &edits)
+{
+    auto device = std::make_unique<EditListDevice>(edits);
+    if (!device->open(QIODevice::ReadOnly)) {
+        LOG_WARN() << "playEditList failed to open edits:" << device->errorString();
+        return false;
+    }
+    if (device->size() <= 0) {
+        LOG_WARN() << "playEditList received empty edits";
+        return false;
+    }
+
+    if (!prepareClip(edits.format, device->size()))
+        return false;
+    startClip(d->source->setClip(std::move(device)));
+    return true;
+}
+
+bool AudioPlaybackEngine::prepareClip(const QAudioFormat &format, qint64 totalBytes)
+{
     stopAll();
+    if (!ensureOutput(format))
+        return false;
 
-    d->bufferData = pcm;
     d->format = format;
-    d->totalBytes = pcm.size();
-    
-    // Calculate duration in milliseconds
-    int bytesPerFrame = format.channelCount() * (format.sampleSize() / 8);
-    int sampleRate = format.sampleRate();
-    if (bytesPerFrame > 0 && sampleRate > 0) {
-        qint64 totalFrames = d->totalBytes / bytesPerFrame;
-        d->durationMs = (totalFrames * 1000.0) / sampleRate;
-    } else {
-        d->durationMs = 0.0;
-    }
-    
-    d->bufferDevice = std::make_unique<QBuffer>(&d->bufferData);
-    d->bufferDevice->open(QIODevice::ReadOnly);
-
-    d->output = std::make_unique<QAudioOutput>(format);
-    connect(d->output.get(), &QAudioOutput::stateChanged, this, [this](QAudio::State state) {
-        if (state == QAudio::IdleState) {
-            stopAll();
-            emit playbackFinished();
-        } else if (state == QAudio::StoppedState && d->output && d->output->error() != QAudio::NoError) {
-            const QString message = tr("Ошибка воспроизведения: %1").arg(d->output->error());
-            emit playbackError(message);
-        }
-    });
+    d->totalBytes = totalBytes;
+    d->durationMs = bytesToMs(d->totalBytes, format);
+    return true;
+}
 
-    d->output->start(d->bufferDevice.get());
+void AudioPlaybackEngine::startClip(qint64 streamOffset)
+{
+    // The clip is heard once everything already handed to the device has played
+    d->clipStartBytes = streamOffset;
     d->playing = true;
-    d->elapsedTimer.start();
+    d->lastClockMs = 0.0;
+    d->anchorClock();
     d->positionTimer->start();
-    return true;
 }
 
 bool AudioPlaybackEngine::playFile(const QString &filePath)
 {
-    QByteArray pcm;
-    QAudioFormat format;
+    auto view = std::make_unique<WavUtils::WavFileView>();
     QString error;
-    if (!WavUtils::readWavFile(filePath, pcm, format, &error)) {
+    if (!view->open(filePath, &error)) {
         LOG_WARN() << "Unable to play file" << filePath << error;
         emit playbackError(error);
         return false;
     }
-    return playBuffer(pcm, format);
+    // playView() stops the previous playback (and releases its view) first,
+    // then plays straight from the mapping kept alive by d->fileView
+    if (!playView(AudioView(view->audio())))
+        return false;
+    d->fileView = std::move(view);
+    return true;
 }
 
 void AudioPlaybackEngine::stopAll()
 {
     d->positionTimer->stop();
-    if (d->output) {
-        d->output->stop();
-        d->output.reset();
-    }
-    if (d->bufferDevice) {
-        d->bufferDevice->close();
-        d->bufferDevice.reset();
-    }
-    if (d->fileDevice) {
-        d->fileDevice->close();
-        d->fileDevice.reset();
-    }
+    // Silence the stream but keep the device open for the next clip
+    if (d->source)
+        d->source->clearClip();
+    d->fileView.reset();
     d->playing = false;
     d->totalBytes = 0;
     d->durationMs = 0.0;
+    d->anchorPositionMs = 0.0;
+    d->lastClockMs = 0.0;
     emit playbackPositionChanged();
 }
 
@@ -126,15 +347,37 @@ bool AudioPlaybackEngine::isPlaying() const
     return d->playing;
 }
 
+bool AudioPlaybackEngine::isOutputActive() const
+{
+    return d->output && d->output->state() == QAudio::ActiveState;
+}
+
 double AudioPlaybackEngine::playbackPositionMs() const
 {
-    if (!d->playing || !d->output) {
+    return d->audiblePositionMs();
+}
+
+double AudioPlaybackEngine::interpolatedPositionMs() const
+{
+    if (!d->playing)
         return 0.0;
-    }
-    
-    // Use processedUSecs() to get accurate position
-    qint64 processedUSecs = d->output->processedUSecs();
-    return processedUSecs / 1000.0; // Convert microseconds to milliseconds
+
+    // Advance the last measurement by wall time, but never further than two
+    // timer ticks so a stalled device does not run the playhead away
+    const double sinceAnchorMs = (d->clock.nsecsElapsed() - d->anchorClockNs) / 1000000.0;
+    const double maxAdvanceMs = 2.0 * d->positionTimer->interval();
+    double positionMs = d->anchorPositionMs + qBound(0.0, sinceAnchorMs, maxAdvanceMs);
+    positionMs = qBound(0.0, positionMs, d->durationMs);
+
+    // Measurements move in device-period steps; keep the clock monotonic
+    positionMs = qMax(positionMs, d->lastClockMs);
+    d->lastClockMs = positionMs;
+    return positionMs;
+}
+
+double AudioPlaybackEngine::outputLatencyMs() const
+{
+    return bytesToMs(d->queuedBytes(), d->outputFormat);
 }
 
 double AudioPlaybackEngine::durationMs() const
@@ -144,8 +387,14 @@ double AudioPlaybackEngine::durationMs() const
 
 void AudioPlaybackEngine::updatePlaybackPosition()
 {
-    if (d->playing) {
-        emit playbackPositionChanged();
+    if (!d->playing)
+        return;
+    // The output never goes idle, so the end of a clip is detected from its position
+    d->anchorClock();
+    if (d->anchorPositionMs >= d->durationMs) {
+        stopAll();
+        emit playbackFinished();
+        return;
     }
+    emit playbackPositionChanged();
 }
-
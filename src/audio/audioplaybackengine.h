@@ -4,21 +4,42 @@
 #include <QAudioFormat>
 #include <QByteArray>
 
+class AudioView;
+struct EditList;
+
 class AudioPlaybackEngine : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(double playbackPositionMs READ playbackPositionMs NOTIFY playbackPositionChanged)
+    Q_PROPERTY(double outputLatencyMs READ outputLatencyMs NOTIFY playbackPositionChanged)
 public:
     explicit AudioPlaybackEngine(QObject *parent = nullptr);
     ~AudioPlaybackEngine() override;
 
     bool playBuffer(const QByteArray &pcm, const QAudioFormat &format);
+    // Plays straight from the view's pages; the view keeps them alive, so the
+    // buffer may be replaced or destroyed during playback
+    bool playView(const AudioView &view);
     bool playFile(const QString &filePath);
+    // Same as playView(), backwards
+    bool playReverse(const AudioView &view);
+    // Renders edits while playing; the source recordings are mapped on start
+    bool playEditList(const EditList &edits);
     void stopAll();
     bool isPlaying() const;
+    // True while the persistent output runs, i.e. the device pulls audio
+    bool isOutputActive() const;
     
-    // Get current playback position in milliseconds
+    // Get current playback position in milliseconds: the audio actually
+    // heard, i.e. excluding what still waits in the device buffer
     double playbackPositionMs() const;
+
+    // Position extrapolated from the last measurement by wall time, cheap
+    // enough to sample on every rendered frame; never moves backwards
+    Q_INVOKABLE double interpolatedPositionMs() const;
+
+    // Audio queued in the device buffer ahead of what is heard
+    double outputLatencyMs() const;
     
     // Get total duration in milliseconds
     double durationMs() const;
@@ -32,6 +53,12 @@ private slots:
     void updatePlaybackPosition();
 
 private:
+    // Opens the persistent output, or reopens it when the format differs
+    bool ensureOutput(const QAudioFormat &format);
+    // Common start of every clip: stop the current one, set up output and duration
+    bool prepareClip(const QAudioFormat &format, qint64 totalBytes);
+    void startClip(qint64 streamOffset);
+
     class Impl;
     Impl *d;
 };
@@ -52,6 +52,21 @@ const AudioBuffer &AudioProject::originalBuffer() const
     return m_originalBuffer;
 }
 
+WaveformPyramid &AudioProject::waveform()
+{
+    return m_waveform;
+}
+
+const WaveformPyramid &AudioProject::waveform() const
+{
+    return m_waveform;
+}
+
+void AudioProject::rebuildWaveform()
+{
+    m_waveform.build(m_originalBuffer);
+}
+
 QVector<SegmentInfo> &AudioProject::segments()
 {
     return m_segments;
@@ -62,6 +77,32 @@ const QVector<SegmentInfo> &AudioProject::segments() const
     return m_segments;
 }
 
+EditList &AudioProject::songEdits()
+{
+    return m_songEdits;
+}
+
+const EditList &AudioProject::songEdits() const
+{
+    return m_songEdits;
+}
+
+EditList &AudioProject::reverseEdits()
+{
+    return m_reverseEdits;
+}
+
+const EditList &AudioProject::reverseEdits() const
+{
+    return m_reverseEdits;
+}
+
+void AudioProject::clearEdits()
+{
+    m_songEdits.clear();
+    m_reverseEdits.clear();
+}
+
 int AudioProject::segmentLengthSeconds() const
 {
     return m_segmentLengthSeconds;
@@ -88,23 +129,32 @@ void AudioProject::resetSegmentStatuses()
         segment.recordingPath.clear();
         segment.reversePath.clear();
     }
+    clearEdits();
 }
 
 void AudioProject::splitIntoSegments()
 {
-    m_segments.clear();
-    const auto &buffer = m_originalBuffer;
-    if (!buffer.format().isValid() || buffer.frameCount() == 0)
-        return;
+    m_segments = computeSegments(m_originalBuffer, m_segmentLengthSeconds);
+    clearEdits();
+    emit segmentsUpdated();
+}
 
-    const qint64 sampleRate = buffer.format().sampleRate();
-    if (sampleRate <= 0)
-        return;
+QVector<SegmentInfo> AudioProject::computeSegments(const AudioBuffer &buffer, int segmentLengthSeconds)
+{
+    if (!buffer.format().isValid())
+        return QVector<SegmentInfo>();
+    return computeSegments(buffer.frameCount(), buffer.format().sampleRate(), segmentLengthSeconds);
+}
+
+QVector<SegmentInfo> AudioProject::computeSegments(qint64 totalFrames, int sampleRate, int segmentLengthSeconds)
+{
+    QVector<SegmentInfo> segments;
+    if (totalFrames <= 0 || sampleRate <= 0)
+        return segments;
 
     const qint64 framesPerSecond = sampleRate;
-    const qint64 framesPerSegment = framesPerSecond * m_segmentLengthSeconds;
+    const qint64 framesPerSegment = framesPerSecond * segmentLengthSeconds;
     const qint64 minFrames = framesPerSecond; // 1 second
-    const qint64 totalFrames = buffer.frameCount();
 
     qint64 remainingFrames = totalFrames;
     int displayIndex = 1;
@@ -119,9 +169,8 @@ void AudioProject::splitIntoSegments()
         }
         if (totalFrames <= minFrames && framesForSegment < minFrames) {
             // whole track shorter than 1 second; skip creating segments
-            m_segments.clear();
-            emit segmentsUpdated();
-            return;
+            segments.clear();
+            return segments;
         }
 
         SegmentInfo info;
@@ -129,12 +178,12 @@ void AudioProject::splitIntoSegments()
         info.startFrame = startFrame;
         info.frameCount = framesForSegment;
         info.durationMs = static_cast<qint64>((static_cast<double>(framesForSegment) / sampleRate) * 1000.0);
-        m_segments.push_back(info);
+        segments.push_back(info);
 
         if (startFrame == 0)
             break;
         remainingFrames = startFrame;
     }
 
-    emit segmentsUpdated();
+    return segments;
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "audiobuffer.h"
+#include "editlist.h"
+#include "waveformpyramid.h"
 
 #include <QObject>
 #include <QString>
@@ -44,15 +46,33 @@ public:
     AudioBuffer &originalBuffer();
     const AudioBuffer &originalBuffer() const;
 
+    // Peak/RMS pyramid of originalBuffer(), rebuilt whenever the buffer is replaced
+    WaveformPyramid &waveform();
+    const WaveformPyramid &waveform() const;
+    void rebuildWaveform();
+
     QVector<SegmentInfo> &segments();
     const QVector<SegmentInfo> &segments() const;
 
+    // Glued song and its reverse as edit lists over the segment recordings;
+    // empty until the segments are glued, cleared whenever segments change
+    EditList &songEdits();
+    const EditList &songEdits() const;
+    EditList &reverseEdits();
+    const EditList &reverseEdits() const;
+    void clearEdits();
+
     int segmentLengthSeconds() const;
     void setSegmentLengthSeconds(int seconds);
 
     void resetSegmentStatuses();
     void splitIntoSegments();
 
+    // Pure segmentation of a buffer, safe to call from worker threads
+    static QVector<SegmentInfo> computeSegments(const AudioBuffer &buffer, int segmentLengthSeconds);
+    // Same layout for a track of totalFrames, e.g. before it is fully decoded
+    static QVector<SegmentInfo> computeSegments(qint64 totalFrames, int sampleRate, int segmentLengthSeconds);
+
 signals:
     void segmentsUpdated();
 
@@ -61,7 +81,10 @@ private:
     QString m_originalFilePath;
     QString m_decodedFilePath;
     AudioBuffer m_originalBuffer;
+    WaveformPyramid m_waveform;
     QVector<SegmentInfo> m_segments;
+    EditList m_songEdits;
+    EditList m_reverseEdits;
     int m_segmentLengthSeconds = 5;
 };
 
@@ -0,0 +1,257 @@
+#include "duplexsession.h"
+
+#include "audiobuffer.h"
+#include "audioplaybackengine.h"
+#include "recordingengine.h"
+#include "wavutils.h"
+#include "../utils/logger.h"
+#include "../utils/pathutils.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTimer>
+#include <QtEndian>
+#include <QtGlobal>
+#include <cstdlib>
+
+namespace {
+// Silence played before the click, so the output is measured while running
+constexpr int kWarmUpMs = 200;
+// The warm-up must have been heard by then, or the output does not start
+constexpr int kWarmUpTimeoutMs = 2000;
+// Calibration clip: a short burst followed by silence for the echo to arrive in
+constexpr int kClickMs = 5;
+constexpr int kClickClipMs = 800;
+// Kept moderate, the calibration may well run into headphones
+constexpr qint16 kClickLevel = 8231; // About -12 dBFS
+// Recording time before stop(); the recorder adds its own tail on top
+constexpr int kCalibrationWindowMs = 1000;
+// Loudest recorded sample must reach this, or the microphone did not hear the click
+constexpr int kMinClickLevel = 650; // About -34 dBFS
+// Onset is the first sample reaching this share of the loudest one
+constexpr double kOnsetRatio = 0.5;
+
+QByteArray makeClick(const QAudioFormat &format)
+{
+    const int channels = format.channelCount();
+    const qint64 frames = static_cast<qint64>(format.sampleRate()) * kClickClipMs / 1000;
+    const qint64 clickFrames = static_cast<qint64>(format.sampleRate()) * kClickMs / 1000;
+    // Square wave at about 1 kHz, which every speaker reproduces
+    const qint64 halfPeriod = qMax(1, format.sampleRate() / 2000);
+
+    QByteArray pcm(static_cast<int>(frames * channels * 2), '\0');
+    auto *samples = reinterpret_cast<qint16 *>(pcm.data());
+    for (qint64 frame = 0; frame < clickFrames; ++frame) {
+        const qint16 value = (frame / halfPeriod) % 2 == 0 ? kClickLevel : -kClickLevel;
+        for (int channel = 0; channel < channels; ++channel)
+            samples[frame * channels + channel] = qToLittleEndian(value);
+    }
+    return pcm;
+}
+} // namespace
+
+DuplexSession::DuplexSession(AudioPlaybackEngine *playback, RecordingEngine *recorder, QObject *parent)
+    : QObject(parent)
+    , m_playback(playback)
+    , m_recorder(recorder)
+    , m_warmUpTimer(new QTimer(this))
+{
+    m_warmUpTimer->setSingleShot(true);
+    connect(m_warmUpTimer, &QTimer::timeout, this, [this]() {
+        if (m_warmingUp)
+            failCalibration("audio output did not start");
+    });
+    connect(m_playback, &AudioPlaybackEngine::playbackFinished, this, &DuplexSession::onPlaybackFinished);
+    connect(m_recorder, &RecordingEngine::recordingStopped, this, &DuplexSession::onRecordingStopped);
+}
+
+bool DuplexSession::start(const AudioView &guide, bool reversed, const QString &filePath, const QAudioFormat &format)
+{
+    if (m_calibrating || guide.isEmpty())
+        return false;
+    if (!m_recorder->isStandbyActive())
+        LOG_WARN() << "Duplex take without microphone standby, alignment is approximate";
+
+    // The guide starts once the playback queue has drained, the recorder
+    // hears it latencyMs after that. Both are measured from this instant.
+    const bool playing = reversed ? m_playback->playReverse(guide) : m_playback->playView(guide);
+    if (!playing)
+        return false;
+    const double offsetMs = m_playback->outputLatencyMs() + m_latencyMs;
+    const qint64 offsetFrames = qRound64(offsetMs * format.sampleRate() / 1000.0);
+    if (!m_recorder->startRecording(filePath, format, offsetFrames)) {
+        m_playback->stopAll();
+        return false;
+    }
+
+    m_active = true;
+    LOG_INFO() << "Duplex take started to" << filePath << "with" << offsetMs << "ms latency compensation";
+    return true;
+}
+
+void DuplexSession::stop()
+{
+    if (!m_active)
+        return;
+    m_playback->stopAll();
+    m_recorder->stop();
+}
+
+bool DuplexSession::isActive() const
+{
+    return m_active;
+}
+
+double DuplexSession::latencyMs() const
+{
+    return m_latencyMs;
+}
+
+void DuplexSession::setLatencyMs(double ms)
+{
+    m_latencyMs = qMax(0.0, ms);
+    m_calibrated = true;
+}
+
+bool DuplexSession::isCalibrated() const
+{
+    return m_calibrated;
+}
+
+bool DuplexSession::calibrate(const QAudioFormat &requestedFormat)
+{
+    if (m_calibrating || m_active || m_recorder->isRecording())
+        return false;
+    // Without standby the first input periods are dropped as warm-up, and
+    // that time would end up in the latency
+    if (!m_recorder->isStandbyActive()) {
+        LOG_WARN() << "Latency calibration needs the microphone in standby";
+        return false;
+    }
+
+    QAudioFormat format = requestedFormat;
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    if (format.sampleRate() <= 0 || format.channelCount() <= 0)
+        return false;
+
+    // An output that is just being opened reports an empty queue while its
+    // start-up delay is still ahead; the click is played once silence has
+    // been heard through it
+    const int warmUpBytes = format.bytesForDuration(kWarmUpMs * 1000);
+    if (!m_playback->playBuffer(QByteArray(warmUpBytes, '\0'), format))
+        return false;
+
+    m_calibrationFormat = format;
+    m_calibrating = true;
+    m_warmingUp = true;
+    m_warmUpTimer->start(kWarmUpTimeoutMs);
+    LOG_INFO() << "Latency calibration started, warming up the output";
+    return true;
+}
+
+bool DuplexSession::startMeasurement()
+{
+    const QString tempDir = PathUtils::defaultTempRoot();
+    PathUtils::ensureDirectory(tempDir);
+    m_calibrationPath = tempDir + QDir::separator() + QStringLiteral("latency_calibration.wav");
+
+    // Same sequence as start(), with the take anchored right at the call
+    if (!m_playback->playBuffer(makeClick(m_calibrationFormat), m_calibrationFormat))
+        return false;
+    m_calibrationQueueMs = m_playback->outputLatencyMs();
+    if (!m_recorder->startRecording(m_calibrationPath, m_calibrationFormat, 0)) {
+        m_playback->stopAll();
+        return false;
+    }
+
+    QTimer::singleShot(kCalibrationWindowMs, this, [this]() {
+        if (m_calibrating && !m_warmingUp)
+            m_recorder->stop();
+    });
+    LOG_INFO() << "Latency calibration click played, playback queue" << m_calibrationQueueMs << "ms";
+    return true;
+}
+
+void DuplexSession::failCalibration(const char *reason)
+{
+    LOG_WARN() << "Latency calibration failed:" << reason;
+    m_calibrating = false;
+    m_warmingUp = false;
+    m_warmUpTimer->stop();
+    m_playback->stopAll();
+    emit calibrationFinished(false, m_latencyMs);
+}
+
+void DuplexSession::onPlaybackFinished()
+{
+    if (!m_warmingUp)
+        return;
+    m_warmingUp = false;
+    m_warmUpTimer->stop();
+    // Queued, so other playbackFinished() listeners still see the calibration running
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!m_calibrating)
+            return;
+        if (!m_playback->isOutputActive())
+            failCalibration("audio output is not running");
+        else if (!startMeasurement())
+            failCalibration("cannot start the click recording");
+    }, Qt::QueuedConnection);
+}
+
+bool DuplexSession::isCalibrating() const
+{
+    return m_calibrating;
+}
+
+void DuplexSession::onRecordingStopped()
+{
+    m_active = false;
+    // During warm-up the calibration take has not started yet
+    if (!m_calibrating || m_warmingUp)
+        return;
+    m_calibrating = false;
+    m_playback->stopAll();
+
+    const double onsetMs = measureClickMs(m_calibrationPath);
+    QFile::remove(m_calibrationPath);
+    if (onsetMs < 0.0) {
+        failCalibration("click not found in the recording");
+        return;
+    }
+
+    setLatencyMs(onsetMs - m_calibrationQueueMs);
+    LOG_INFO() << "Latency calibrated:" << m_latencyMs << "ms beyond the playback queue, click heard after"
+               << onsetMs << "ms";
+    emit calibrationFinished(true, m_latencyMs);
+}
+
+double DuplexSession::measureClickMs(const QString &filePath) const
+{
+    WavUtils::WavFileView view;
+    QString error;
+    if (!view.open(filePath, &error)) {
+        LOG_WARN() << "Cannot read calibration recording" << filePath << error;
+        return -1.0;
+    }
+    const QAudioFormat &format = view.format();
+    if (format.sampleSize() != 16 || format.channelCount() <= 0 || format.sampleRate() <= 0)
+        return -1.0;
+
+    const auto *samples = reinterpret_cast<const qint16 *>(view.pcmData());
+    const qint64 sampleCount = view.pcmSize() / 2;
+    int peak = 0;
+    for (qint64 i = 0; i < sampleCount; ++i)
+        peak = qMax(peak, std::abs(static_cast<int>(qFromLittleEndian(samples[i]))));
+    if (peak < kMinClickLevel)
+        return -1.0;
+
+    const int threshold = static_cast<int>(peak * kOnsetRatio);
+    for (qint64 i = 0; i < sampleCount; ++i) {
+        if (std::abs(static_cast<int>(qFromLittleEndian(samples[i]))) >= threshold)
+            return (i / format.channelCount()) * 1000.0 / format.sampleRate();
+    }
+    return -1.0;
+}
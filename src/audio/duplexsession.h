@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QAudioFormat>
+#include <QObject>
+#include <QString>
+
+class AudioPlaybackEngine;
+class QTimer;
+class AudioView;
+class RecordingEngine;
+
+// Records a take while a guide clip plays. Both engines are started back to
+// back at one instant, the take is anchored to that instant and the measured
+// output-to-input latency is dropped from its start, so a take sung along
+// with the guide comes out aligned with it.
+class DuplexSession : public QObject
+{
+    Q_OBJECT
+public:
+    // The engines are not owned
+    DuplexSession(AudioPlaybackEngine *playback, RecordingEngine *recorder, QObject *parent = nullptr);
+
+    // Plays guide (backwards when reversed) and records into filePath. The
+    // anchoring is exact only when the recorder is in hot standby.
+    bool start(const AudioView &guide, bool reversed, const QString &filePath, const QAudioFormat &format);
+    // Stops the guide and the take; the take is saved as with RecordingEngine::stop()
+    void stop();
+    bool isActive() const;
+
+    // Round trip from output to input beyond the playback queue: converters,
+    // driver buffers and air. The queue itself is read when a session starts.
+    double latencyMs() const;
+    void setLatencyMs(double ms);
+    bool isCalibrated() const;
+
+    // Loopback calibration: plays a click and finds it in a short recording,
+    // so the microphone has to hear the speakers. Needs the recorder in hot
+    // standby in format; the output is first warmed up with silence. Finishes
+    // asynchronously with calibrationFinished().
+    bool calibrate(const QAudioFormat &format);
+    bool isCalibrating() const;
+
+signals:
+    void calibrationFinished(bool ok, double latencyMs);
+
+private slots:
+    void onPlaybackFinished();
+    void onRecordingStopped();
+
+private:
+    // Second calibration step, once the output runs: click and recording
+    bool startMeasurement();
+    void failCalibration(const char *reason);
+    // Onset of the click in the calibration recording, -1 if it was not heard
+    double measureClickMs(const QString &filePath) const;
+
+    AudioPlaybackEngine *m_playback;
+    RecordingEngine *m_recorder;
+    double m_latencyMs = 0.0;
+    bool m_calibrated = false;
+    bool m_active = false;
+    bool m_calibrating = false;
+    bool m_warmingUp = false;
+    QTimer *m_warmUpTimer;
+    QAudioFormat m_calibrationFormat;
+    QString m_calibrationPath;
+    double m_calibrationQueueMs = 0.0;
+};
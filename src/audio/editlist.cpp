@@ -0,0 +1,227 @@
+#include "editlist.h"
+
+#include "audiobuffer.h"
+#include "../utils/logger.h"
+
+#include <QHash>
+#include <QObject>
+#include <QtGlobal>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr qint64 kRenderChunkBytes = 256 * 1024;
+
+qint64 bytesPerFrame(const QAudioFormat &format)
+{
+    if (!format.isValid() || format.sampleSize() <= 0)
+        return 0;
+    return static_cast<qint64>(format.sampleSize() / 8) * format.channelCount();
+}
+
+bool sameLayout(const QAudioFormat &a, const QAudioFormat &b)
+{
+    return a.sampleRate() == b.sampleRate()
+        && a.channelCount() == b.channelCount()
+        && a.sampleSize() == b.sampleSize();
+}
+
+// Copies bytes [offset, offset + length) of the frame-reversed range into out
+void copyReversed(const char *range, qint64 rangeBytes, qint64 frameBytes, const QAudioFormat &format,
+                  qint64 offset, qint64 length, char *out)
+{
+    const qint64 frameCount = rangeBytes / frameBytes;
+    const auto byteAt = [&](qint64 pos) {
+        return range[(frameCount - 1 - pos / frameBytes) * frameBytes + pos % frameBytes];
+    };
+
+    const qint64 end = offset + length;
+    while (offset < end && offset % frameBytes != 0)
+        *out++ = byteAt(offset++);
+
+    const qint64 firstFrame = offset / frameBytes;
+    const qint64 wholeFrames = (end - offset) / frameBytes;
+    if (wholeFrames > 0) {
+        AudioBuffer::reverseFrames(range + (frameCount - firstFrame - wholeFrames) * frameBytes, out, wholeFrames, format);
+        out += wholeFrames * frameBytes;
+        offset += wholeFrames * frameBytes;
+    }
+
+    while (offset < end)
+        *out++ = byteAt(offset++);
+}
+} // namespace
+
+bool EditList::isEmpty() const
+{
+    return entries.isEmpty();
+}
+
+void EditList::clear()
+{
+    format = QAudioFormat();
+    entries.clear();
+}
+
+qint64 EditList::frameCount() const
+{
+    qint64 frames = 0;
+    for (const EditEntry &entry : entries)
+        frames += entry.frameCount;
+    return frames;
+}
+
+qint64 EditList::durationMs() const
+{
+    if (!format.isValid() || format.sampleRate() <= 0)
+        return 0;
+    return frameCount() * 1000 / format.sampleRate();
+}
+
+bool EditList::render(const QString &filePath, QString *errorString) const
+{
+    EditListDevice device(*this);
+    if (!device.open(QIODevice::ReadOnly)) {
+        if (errorString)
+            *errorString = device.errorString();
+        return false;
+    }
+
+    WavUtils::WavWriter writer;
+    if (!writer.open(filePath, format, errorString))
+        return false;
+
+    QByteArray chunk(static_cast<int>(kRenderChunkBytes), Qt::Uninitialized);
+    while (!device.atEnd()) {
+        const qint64 read = device.read(chunk.data(), chunk.size());
+        if (read <= 0 || !writer.append(chunk.constData(), read)) {
+            writer.discard();
+            if (errorString)
+                *errorString = QObject::tr("Ошибка записи файла: %1").arg(filePath);
+            LOG_WARN() << "Failed to render edit list to" << filePath;
+            return false;
+        }
+    }
+    return writer.finalize(errorString);
+}
+
+EditListDevice::EditListDevice(const EditList &edits, QObject *parent)
+    : QIODevice(parent)
+    , m_edits(edits)
+    , m_frameBytes(bytesPerFrame(edits.format))
+{
+}
+
+EditListDevice::~EditListDevice()
+{
+    close();
+}
+
+bool EditListDevice::open(OpenMode mode)
+{
+    if (mode & WriteOnly) {
+        setErrorString(QStringLiteral("EditListDevice is read-only"));
+        return false;
+    }
+    if (m_frameBytes <= 0) {
+        setErrorString(tr("Неверный формат списка правок"));
+        return false;
+    }
+
+    m_views.clear();
+    m_pieces.clear();
+    m_size = 0;
+
+    // Each source is mapped once, however many entries refer to it
+    QHash<QString, WavUtils::WavFileView *> views;
+    for (const EditEntry &entry : m_edits.entries) {
+        WavUtils::WavFileView *view = views.value(entry.sourcePath);
+        if (!view) {
+            auto opened = std::make_unique<WavUtils::WavFileView>();
+            QString error;
+            if (!opened->open(entry.sourcePath, &error)) {
+                setErrorString(tr("Ошибка чтения %1: %2").arg(entry.sourcePath).arg(error));
+                m_views.clear();
+                return false;
+            }
+            if (!sameLayout(opened->format(), m_edits.format)) {
+                setErrorString(tr("Несовместимые форматы сегментов"));
+                m_views.clear();
+                return false;
+            }
+            view = opened.get();
+            views.insert(entry.sourcePath, view);
+            m_views.push_back(std::move(opened));
+        }
+
+        // Clamp the range to what the file actually holds
+        const qint64 sourceFrames = view->pcmSize() / m_frameBytes;
+        const qint64 startFrame = qBound<qint64>(0, entry.startFrame, sourceFrames);
+        const qint64 frames = qBound<qint64>(0, entry.frameCount, sourceFrames - startFrame);
+        if (frames <= 0)
+            continue;
+
+        Piece piece;
+        piece.data = view->pcmData() + startFrame * m_frameBytes;
+        piece.offset = m_size;
+        piece.size = frames * m_frameBytes;
+        piece.reversed = entry.reversed;
+        m_pieces.append(piece);
+        m_size += piece.size;
+    }
+
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void EditListDevice::close()
+{
+    QIODevice::close();
+    m_pieces.clear();
+    m_views.clear();
+    m_size = 0;
+}
+
+bool EditListDevice::isSequential() const
+{
+    return false;
+}
+
+qint64 EditListDevice::size() const
+{
+    return m_size;
+}
+
+qint64 EditListDevice::readData(char *data, qint64 maxlen)
+{
+    qint64 pos = this->pos();
+    const qint64 end = qMin(m_size, pos + maxlen);
+    if (pos >= end)
+        return 0;
+
+    // Last piece starting at or before pos
+    auto it = std::upper_bound(m_pieces.cbegin(), m_pieces.cend(), pos,
+                               [](qint64 value, const Piece &piece) { return value < piece.offset; });
+    int index = static_cast<int>(it - m_pieces.cbegin()) - 1;
+
+    char *out = data;
+    while (pos < end && index < m_pieces.size()) {
+        const Piece &piece = m_pieces[index];
+        const qint64 offset = pos - piece.offset;
+        const qint64 length = qMin(piece.size - offset, end - pos);
+        if (piece.reversed)
+            copyReversed(piece.data, piece.size, m_frameBytes, m_edits.format, offset, length, out);
+        else
+            memcpy(out, piece.data + offset, static_cast<size_t>(length));
+        out += length;
+        pos += length;
+        ++index;
+    }
+    return out - data;
+}
+
+qint64 EditListDevice::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+    return -1;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "wavutils.h"
+
+#include <QAudioFormat>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+// One piece of an edit list: a frame range of a WAV file, played forwards or backwards
+struct EditEntry
+{
+    QString sourcePath;
+    qint64 startFrame = 0; // Range within the source, i.e. after trimming
+    qint64 frameCount = 0;
+    bool reversed = false;
+};
+
+// Non-destructive description of a rendered track: the entries are played one
+// after another. Nothing is materialized until an EditListDevice reads it, so
+// changing a trim only means replacing one entry.
+struct EditList
+{
+    QAudioFormat format;
+    QVector<EditEntry> entries;
+
+    bool isEmpty() const;
+    void clear();
+    qint64 frameCount() const;
+    qint64 durationMs() const;
+
+    // Streams the list into a 16-bit PCM WAV file through an EditListDevice
+    bool render(const QString &filePath, QString *errorString = nullptr) const;
+};
+
+// Read-only, seekable device rendering an EditList on the fly. open() maps
+// every source file; reads then copy forward ranges straight from the mapping
+// and reverse backward ranges frame by frame into the caller's buffer.
+class EditListDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit EditListDevice(const EditList &edits, QObject *parent = nullptr);
+    ~EditListDevice() override;
+
+    // Fails, with errorString() set, when a source is missing or its format
+    // does not match the list format
+    bool open(OpenMode mode) override;
+    void close() override;
+
+    bool isSequential() const override;
+    qint64 size() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    struct Piece
+    {
+        const char *data = nullptr; // First byte of the range in the source mapping
+        qint64 offset = 0;          // Position of the piece in the rendered stream
+        qint64 size = 0;
+        bool reversed = false;
+    };
+
+    EditList m_edits;
+    qint64 m_frameBytes = 0;
+    std::vector<std::unique_ptr<WavUtils::WavFileView>> m_views;
+    QVector<Piece> m_pieces;
+    qint64 m_size = 0;
+};
@@ -0,0 +1,170 @@
+#include "glueengine.h"
+
+#include "pcmcache.h"
+#include "segmenttrimmer.h"
+#include "volumeanalyzer.h"
+#include "wavutils.h"
+#include "../utils/logger.h"
+
+#include <QFileInfo>
+#include <QThread>
+#include <QtGlobal>
+
+namespace {
+// One segment's contribution to the edit lists, produced by a single worker task
+struct PreparedSegment
+{
+    bool ok = false;
+    QString errorString;
+    QAudioFormat format;
+    TrimRange range;
+};
+
+bool sameLayout(const QAudioFormat &a, const QAudioFormat &b)
+{
+    return a.sampleRate() == b.sampleRate()
+        && a.channelCount() == b.channelCount()
+        && a.sampleSize() == b.sampleSize();
+}
+} // namespace
+
+GlueEngine::GlueEngine(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void GlueEngine::setMaxThreadCount(int threads)
+{
+    m_pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+}
+
+int GlueEngine::maxThreadCount() const
+{
+    return m_pool.maxThreadCount();
+}
+
+void GlueEngine::setPcmCache(PcmCache *cache)
+{
+    m_pcmCache = cache;
+}
+
+bool GlueEngine::buildEditLists(const QVector<SegmentInfo> &segments, double noiseThreshold,
+                                EditList &song, EditList &reverse, QString *errorString)
+{
+    const auto fail = [errorString](const QString &message) {
+        if (errorString)
+            *errorString = message;
+        return false;
+    };
+
+    if (segments.isEmpty())
+        return fail(tr("Нет сегментов для склейки"));
+
+    // Find the trimmed range of every segment once, in parallel
+    QVector<PreparedSegment> prepared(segments.size());
+    for (int i = 0; i < segments.size(); ++i) {
+        PreparedSegment *result = &prepared[i];
+        const SegmentInfo segment = segments[i];
+        PcmCache *cache = m_pcmCache;
+        m_pool.start([result, segment, noiseThreshold, cache]() {
+            if (segment.recordingPath.isEmpty() || !QFileInfo::exists(segment.recordingPath)) {
+                result->errorString = tr("Файл записи сегмента %1 не найден").arg(segment.displayIndex);
+                LOG_WARN() << "Recording file not found for segment" << segment.displayIndex;
+                return;
+            }
+
+            // Trim noise from start and end (use manual boundaries if set). With a
+            // cache this only needs the recording's volume profile, otherwise the
+            // file is mapped and scanned.
+            const SegmentTrimmer trimmer(noiseThreshold);
+            QString error;
+            const PcmCache::ProfilePtr profile = cache ? cache->profile(segment.recordingPath, 100, &error)
+                                                       : PcmCache::ProfilePtr();
+            WavUtils::WavFileView view;
+            if (profile) {
+                const PcmCache::EntryPtr cached = cache->load(segment.recordingPath, &error);
+                if (cached)
+                    result->format = cached->format;
+                result->range = trimmer.trim(*profile, segment.trimStartMs, segment.trimEndMs);
+            } else if (view.open(segment.recordingPath, &error)) {
+                result->format = view.format();
+                // Past 2 GiB the whole recording is measured through pages over the mapping
+                result->range = view.fitsByteArray()
+                    ? trimmer.trim(view.pcm(), view.format(), segment.trimStartMs, segment.trimEndMs)
+                    : trimmer.trim(VolumeAnalyzer::computeProfile(view.audio(), 100), segment.trimStartMs,
+                                   segment.trimEndMs);
+            }
+            if (!result->format.isValid()) {
+                result->errorString = tr("Ошибка чтения сегмента %1: %2").arg(segment.displayIndex).arg(error);
+                LOG_WARN() << "Failed to read segment" << segment.displayIndex << error;
+                return;
+            }
+            if (result->range.isEmpty()) {
+                result->errorString = tr("Ошибка: сегмент %1 не содержит звука после обрезки").arg(segment.displayIndex);
+                LOG_WARN() << "Segment" << segment.displayIndex << "is empty after trimming";
+                return;
+            }
+            result->ok = true;
+        });
+    }
+    m_pool.waitForDone();
+
+    // Report the first failure in display order, same as a sequential pass would
+    const QAudioFormat format = prepared.first().format;
+    for (const PreparedSegment &segment : prepared) {
+        if (!segment.ok)
+            return fail(segment.errorString);
+        if (!sameLayout(format, segment.format)) {
+            LOG_WARN() << "Incompatible segment formats";
+            return fail(tr("Несовместимые форматы сегментов"));
+        }
+    }
+
+    // Segments are stored in reverse order (from end to start of song):
+    // segment 1 = end of song, segment 2, segment 3, segment 4 = start of song
+    // We glue them in display order (1 → 2 → 3 → 4) so that after reversing
+    // the glued song, we get correct order (4 → 3 → 2 → 1 = start to end)
+    song.clear();
+    reverse.clear();
+    song.format = format;
+    reverse.format = format;
+    for (int i = 0; i < prepared.size(); ++i) {
+        const TrimRange &range = prepared[i].range;
+        song.entries.append({segments[i].recordingPath, range.startFrame, range.frameCount(), false});
+        LOG_INFO() << "Segment" << segments[i].displayIndex << "glued as frames" << range.startFrame
+                   << "-" << range.endFrame;
+    }
+    // Reversed song: each segment reversed individually, glued from start of song to end
+    for (int i = prepared.size() - 1; i >= 0; --i) {
+        EditEntry entry = song.entries[i];
+        entry.reversed = true;
+        reverse.entries.append(entry);
+    }
+    return true;
+}
+
+bool GlueEngine::glue(const QVector<SegmentInfo> &segments, double noiseThreshold,
+                      const QString &songPath, const QString &reversePath, QString *errorString)
+{
+    EditList song;
+    EditList reverse;
+    if (!buildEditLists(segments, noiseThreshold, song, reverse, errorString))
+        return false;
+
+    QString error;
+    if (!song.render(songPath, &error)) {
+        LOG_WARN() << "Failed to write glued song:" << error;
+        if (errorString)
+            *errorString = tr("Ошибка сохранения склеенной песни: %1").arg(error);
+        return false;
+    }
+    LOG_INFO() << "Normal glued song saved to" << songPath;
+
+    if (!reverse.render(reversePath, &error)) {
+        LOG_WARN() << "Failed to write reversed song:" << error;
+        if (errorString)
+            *errorString = tr("Ошибка сохранения реверса: %1").arg(error);
+        return false;
+    }
+    return true;
+}
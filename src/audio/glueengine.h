@@ -0,0 +1,41 @@
+#pragma once
+
+#include "audioproject.h"
+#include "editlist.h"
+
+#include <QObject>
+#include <QThreadPool>
+
+class PcmCache;
+
+// Builds the glued song and its reverse from recorded segments. The trim of
+// every segment is found once on a worker thread; both results are edit lists
+// over the recordings, rendered to files only when asked to.
+class GlueEngine : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GlueEngine(QObject *parent = nullptr);
+
+    // Worker threads used for segment preparation; defaults to the ideal thread count
+    void setMaxThreadCount(int threads);
+    int maxThreadCount() const;
+
+    // Optional cache segment recordings are read through; not owned
+    void setPcmCache(PcmCache *cache);
+
+    // song lists the trimmed segments in display order, reverse each segment
+    // reversed, in the opposite order. No PCM is copied or written. Blocks
+    // until every recording is measured, so callers run it on a worker thread.
+    bool buildEditLists(const QVector<SegmentInfo> &segments, double noiseThreshold,
+                        EditList &song, EditList &reverse, QString *errorString = nullptr);
+
+    // buildEditLists() followed by rendering song to songPath and reverse to
+    // reversePath. Blocks until both files are complete.
+    bool glue(const QVector<SegmentInfo> &segments, double noiseThreshold,
+              const QString &songPath, const QString &reversePath, QString *errorString = nullptr);
+
+private:
+    QThreadPool m_pool;
+    PcmCache *m_pcmCache = nullptr;
+};
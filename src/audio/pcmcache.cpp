@@ -0,0 +1,137 @@
+#include "pcmcache.h"
+
+#include "wavutils.h"
+#include "../utils/logger.h"
+
+#include <QFileInfo>
+
+PcmCache::PcmCache(qint64 byteBudget)
+    : m_byteBudget(byteBudget)
+{
+}
+
+PcmCache::EntryPtr PcmCache::load(const QString &filePath, QString *errorString)
+{
+    const QFileInfo info(filePath);
+    const QString key = info.absoluteFilePath();
+    const qint64 fileSize = info.size();
+    const QDateTime modified = info.lastModified();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_slots.find(key);
+        if (it != m_slots.end()) {
+            if (it->fileSize == fileSize && it->modified == modified) {
+                m_lru.splice(m_lru.begin(), m_lru, it->lruPosition);
+                return it->entry;
+            }
+            LOG_INFO() << "PCM cache entry is stale, reloading:" << key;
+            removeLocked(key);
+        }
+    }
+
+    // Read outside the lock so other files can be served meanwhile
+    WavUtils::WavFileView view;
+    if (!view.open(filePath, errorString))
+        return EntryPtr();
+    auto entry = std::make_shared<Entry>();
+    entry->format = view.format();
+    entry->audio = view.detachedAudio();
+    view.close();
+
+    QMutexLocker locker(&m_mutex);
+    // Another thread may have loaded the same file while we were reading
+    removeLocked(key);
+    if (entry->audio.byteCount() > m_byteBudget)
+        return entry; // too large to keep, serve it uncached
+
+    m_lru.push_front(key);
+    Slot slot;
+    slot.entry = entry;
+    slot.fileSize = fileSize;
+    slot.modified = modified;
+    slot.lruPosition = m_lru.begin();
+    m_slots.insert(key, slot);
+    m_cachedBytes += entry->audio.byteCount();
+    evictLocked();
+    return entry;
+}
+
+PcmCache::ProfilePtr PcmCache::profile(const QString &filePath, int windowSizeMs, QString *errorString)
+{
+    const EntryPtr entry = load(filePath, errorString);
+    if (!entry)
+        return ProfilePtr();
+
+    const QString key = QFileInfo(filePath).absoluteFilePath();
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_slots.find(key);
+        if (it != m_slots.end() && it->entry == entry) {
+            const ProfilePtr cached = it->profiles.value(windowSizeMs);
+            if (cached)
+                return cached;
+        }
+    }
+
+    // Measured on the cached pages, no copy
+    auto result = std::make_shared<const VolumeProfile>(VolumeAnalyzer::computeProfile(entry->audio, windowSizeMs));
+
+    QMutexLocker locker(&m_mutex);
+    // Only attach it if the slot still holds the PCM it was measured from
+    auto it = m_slots.find(key);
+    if (it != m_slots.end() && it->entry == entry)
+        it->profiles.insert(windowSizeMs, result);
+    return result;
+}
+
+void PcmCache::invalidate(const QString &filePath)
+{
+    QMutexLocker locker(&m_mutex);
+    removeLocked(QFileInfo(filePath).absoluteFilePath());
+}
+
+void PcmCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_slots.clear();
+    m_lru.clear();
+    m_cachedBytes = 0;
+}
+
+void PcmCache::setByteBudget(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_byteBudget = qMax<qint64>(0, bytes);
+    evictLocked();
+}
+
+qint64 PcmCache::byteBudget() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_byteBudget;
+}
+
+qint64 PcmCache::cachedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cachedBytes;
+}
+
+void PcmCache::removeLocked(const QString &filePath)
+{
+    auto it = m_slots.find(filePath);
+    if (it == m_slots.end())
+        return;
+    m_cachedBytes -= it->entry->audio.byteCount();
+    m_lru.erase(it->lruPosition);
+    m_slots.erase(it);
+}
+
+void PcmCache::evictLocked()
+{
+    while (m_cachedBytes > m_byteBudget && !m_lru.empty()) {
+        const QString oldest = m_lru.back();
+        removeLocked(oldest);
+    }
+}
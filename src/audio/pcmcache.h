@@ -0,0 +1,68 @@
+#pragma once
+
+#include "volumeanalyzer.h"
+
+#include <QAudioFormat>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <list>
+#include <memory>
+
+// Decoded WAV recordings kept in memory, least recently used first out once
+// the byte budget is exceeded. An entry is only served while the file on disk
+// still has the size and modification time it was loaded with, so a rewritten
+// recording is reloaded even if invalidate() was missed. Thread-safe.
+class PcmCache
+{
+public:
+    struct Entry
+    {
+        QAudioFormat format;
+        // Paged, so recordings of any length are held
+        AudioBuffer audio;
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+    using ProfilePtr = std::shared_ptr<const VolumeProfile>;
+
+    static constexpr qint64 kDefaultByteBudget = 256LL * 1024 * 1024;
+
+    explicit PcmCache(qint64 byteBudget = kDefaultByteBudget);
+
+    // Returns the cached PCM of filePath, reading the WAV file on a miss.
+    // The entry stays valid for the caller even if it is evicted meanwhile.
+    EntryPtr load(const QString &filePath, QString *errorString = nullptr);
+
+    // Per-window RMS/peak of filePath, measured once per window size and kept
+    // with the PCM entry; classifying it against a threshold needs no PCM access
+    ProfilePtr profile(const QString &filePath, int windowSizeMs = 100, QString *errorString = nullptr);
+
+    void invalidate(const QString &filePath);
+    void clear();
+
+    void setByteBudget(qint64 bytes);
+    qint64 byteBudget() const;
+    qint64 cachedBytes() const;
+
+private:
+    struct Slot
+    {
+        EntryPtr entry;
+        QHash<int, ProfilePtr> profiles;
+        qint64 fileSize = 0;
+        QDateTime modified;
+        std::list<QString>::iterator lruPosition;
+    };
+
+    void removeLocked(const QString &filePath);
+    void evictLocked();
+
+    mutable QMutex m_mutex;
+    QHash<QString, Slot> m_slots;
+    // Most recently used at the front
+    std::list<QString> m_lru;
+    qint64 m_byteBudget;
+    qint64 m_cachedBytes = 0;
+};
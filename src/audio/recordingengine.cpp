@@ -2,19 +2,157 @@
 
 #include <QAudioDeviceInfo>
 #include <QAudioInput>
-#include <QBuffer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
 #include <QTimer>
+#include <QWaitCondition>
+#include <atomic>
 #include <memory>
 
+#include "ringbuffer.h"
 #include "wavutils.h"
 #include "../utils/logger.h"
 
+namespace {
+
+// Seconds of audio the capture ring can hold while the writer thread is busy
+constexpr int kCaptureRingSeconds = 4;
+// Backstop for backends that are slow to emit readyRead; about one typical period
+constexpr int kNotifyIntervalMs = 20;
+// Tail delay when the device does not report its buffer size
+constexpr int kFallbackTailMs = 250;
+// Pre-roll must fit the capture ring together with the first live periods
+constexpr int kMaxPreRollMs = 2000;
+
+qint64 bytesPerSecond(const QAudioFormat &format)
+{
+    return static_cast<qint64>(format.sampleRate()) * format.channelCount() * (format.sampleSize() / 8);
+}
+
+// Format the input is actually opened with for a requested format
+QAudioFormat negotiateFormat(const QAudioDeviceInfo &deviceInfo, const QAudioFormat &requestedFormat)
+{
+    QAudioFormat format = requestedFormat;
+    if (!deviceInfo.isFormatSupported(requestedFormat)) {
+        format = deviceInfo.nearestFormat(requestedFormat);
+        LOG_WARN() << "Requested format is not supported. Using nearest input format.";
+    }
+
+    if (format.sampleSize() != 16 || format.sampleType() != QAudioFormat::SignedInt) {
+        format.setSampleSize(16);
+        format.setSampleType(QAudioFormat::SignedInt);
+    }
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec(QStringLiteral("audio/pcm"));
+    return format;
+}
+
+// Drains the capture ring into a streaming WAV file on its own thread, so the
+// GUI thread only copies each device period once and memory stays constant
+// no matter how long the take is.
+class CaptureWriter
+{
+public:
+    ~CaptureWriter()
+    {
+        finish();
+    }
+
+    bool start(const QString &filePath, const QAudioFormat &format)
+    {
+        QString error;
+        if (!m_writer.open(filePath, format, &error)) {
+            LOG_WARN() << "Failed to open recording file" << filePath << error;
+            return false;
+        }
+        const int frameBytes = format.channelCount() * (format.sampleSize() / 8);
+        m_ring.reset(static_cast<qint64>(format.sampleRate()) * frameBytes * kCaptureRingSeconds);
+        m_stopping = false;
+        m_droppedBytes = 0;
+        m_thread.reset(QThread::create([this]() { run(); }));
+        m_thread->start();
+        return true;
+    }
+
+    // Producer side, called from the thread that reads the audio input
+    void push(const char *data, qint64 size)
+    {
+        const qint64 written = m_ring.write(data, size);
+        if (written < size)
+            m_droppedBytes += size - written;
+        QMutexLocker locker(&m_mutex);
+        m_wake.wakeOne();
+    }
+
+    // Flushes what is left in the ring, finalizes the WAV file and joins the
+    // writer thread. Only the last few device periods are still pending here.
+    bool finish()
+    {
+        if (!m_thread)
+            return false;
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+            m_wake.wakeOne();
+        }
+        m_thread->wait();
+        m_thread.reset();
+        if (m_droppedBytes > 0)
+            LOG_WARN() << "Recording writer fell behind, dropped" << m_droppedBytes << "bytes";
+        const bool hasData = m_writer.dataSize() > 0;
+        if (!hasData) {
+            m_writer.discard();
+            return false;
+        }
+        return m_writer.finalize();
+    }
+
+    qint64 bytesWritten() const
+    {
+        return m_writer.dataSize();
+    }
+
+private:
+    void run()
+    {
+        QByteArray chunk(64 * 1024, Qt::Uninitialized);
+        for (;;) {
+            qint64 bytes = 0;
+            while ((bytes = m_ring.read(chunk.data(), chunk.size())) > 0)
+                m_writer.append(chunk.constData(), bytes);
+
+            QMutexLocker locker(&m_mutex);
+            if (m_stopping && m_ring.availableToRead() == 0)
+                break;
+            if (!m_stopping && m_ring.availableToRead() == 0)
+                m_wake.wait(&m_mutex, 100);
+        }
+    }
+
+    RingBuffer m_ring;
+    WavUtils::WavWriter m_writer;
+    std::unique_ptr<QThread> m_thread;
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_stopping = false;
+    std::atomic<qint64> m_droppedBytes{0};
+};
+
+} // namespace
+
 class RecordingEngine::Impl
 {
 public:
     std::unique_ptr<QAudioInput> audioInput;
-    std::unique_ptr<QBuffer> bufferDevice;
-    QByteArray bufferData;
+    // Pull-mode device owned by audioInput
+    QIODevice *inputDevice = nullptr;
+    CaptureWriter writer;
+    QByteArray readChunk;
+    // Live bytes still to be dropped before the take begins
+    qint64 skipBytes = 0;
+    // Bytes delivered by the device since start, including the discarded warm-up
+    qint64 capturedBytes = 0;
     QAudioFormat format;
     QString filePath;
     bool recording = false;
@@ -22,71 +160,100 @@ public:
     QAudioFormat preparedFormat;
     bool formatPrepared = false;
     QTimer* stopTimer = nullptr;
-    QTimer* readyCheckTimer = nullptr;
-    QTimer* dataCheckTimer = nullptr; // Timer to check if data is actually being written
-    int bufferSizeWhenReady = 0; // Track buffer size when device becomes ready
+    QElapsedTimer startClock; // Click to first period, for the log
+
+    // Hot standby: audioInput stays open between takes and feeds preRoll
+    int preRollMs = 0;
+    bool standby = false;
+    RingBuffer preRoll;
+
+    // Reads everything the device has buffered. The first non-empty read is
+    // the warm-up that proves the microphone is live and is dropped; from then
+    // on data is streamed to disk. Returns true when this call made the
+    // recording ready.
+    bool drainInput()
+    {
+        if (!inputDevice)
+            return false;
+        bool becameReady = false;
+        for (;;) {
+            const qint64 bytes = inputDevice->read(readChunk.data(), readChunk.size());
+            if (bytes <= 0)
+                break;
+            capturedBytes += bytes;
+            if (!recording) {
+                keepPreRoll(readChunk.constData(), bytes);
+            } else if (recordingReady) {
+                const qint64 skipped = qMin(skipBytes, bytes);
+                skipBytes -= skipped;
+                if (bytes > skipped)
+                    writer.push(readChunk.constData() + skipped, bytes - skipped);
+            } else {
+                recordingReady = true;
+                becameReady = true;
+            }
+        }
+        return becameReady;
+    }
+
+    // Standby input between takes: only the newest preRollMs are kept. The
+    // ring is written and read on this thread only, skip() makes room.
+    void keepPreRoll(const char *data, qint64 size)
+    {
+        if (size > preRoll.capacity()) {
+            data += size - preRoll.capacity();
+            size = preRoll.capacity();
+        }
+        const qint64 missing = size - preRoll.availableToWrite();
+        if (missing > 0)
+            preRoll.skip(missing);
+        preRoll.write(data, size);
+    }
+
+    // Time until everything the device has buffered reaches us: its buffer
+    // plus one period in flight
+    int tailDelayMs() const
+    {
+        const qint64 rate = bytesPerSecond(format);
+        if (!audioInput || rate <= 0 || audioInput->bufferSize() <= 0)
+            return kFallbackTailMs;
+        const qint64 bytes = audioInput->bufferSize() + qMax(0, audioInput->periodSize());
+        return static_cast<int>((bytes * 1000 + rate - 1) / rate);
+    }
+
+    // Closes the input; a standby input is left open for the next take
+    void releaseInput()
+    {
+        if (standby)
+            return;
+        audioInput.reset();
+    }
+
+    // Stops the device (unless in standby) and completes the WAV file;
+    // returns true if a file was written
+    bool finishCapture()
+    {
+        drainInput();
+        if (!standby) {
+            if (audioInput)
+                audioInput->stop();
+            inputDevice = nullptr;
+        }
+        const bool saved = writer.finish();
+        if (saved)
+            LOG_INFO() << "Recording saved to" << filePath << "size:" << writer.bytesWritten() << "bytes";
+        return saved;
+    }
 };
 
 RecordingEngine::RecordingEngine(QObject *parent)
     : QObject(parent)
     , d(new Impl())
 {
+    // Single shot, armed by stop() with the device's own latency
     d->stopTimer = new QTimer(this);
     d->stopTimer->setSingleShot(true);
-    d->stopTimer->setInterval(250); // 0.25 seconds delay to capture tail
     connect(d->stopTimer, &QTimer::timeout, this, &RecordingEngine::onStopTimerTimeout);
-    
-    d->readyCheckTimer = new QTimer(this);
-    d->readyCheckTimer->setSingleShot(false); // Repeat until ready
-    d->readyCheckTimer->setInterval(100); // Check every 100ms
-    connect(d->readyCheckTimer, &QTimer::timeout, this, [this]() {
-        if (d->recording && !d->recordingReady && d->audioInput) {
-            QAudio::State state = d->audioInput->state();
-            LOG_INFO() << "Ready check timer: current state is" << state;
-            if (state == QAudio::ActiveState || state == QAudio::IdleState) {
-                // Device is in ready state - now check if data is actually being written
-                d->readyCheckTimer->stop();
-                // Start checking for actual data recording
-                if (d->dataCheckTimer) {
-                    d->dataCheckTimer->start();
-                    LOG_INFO() << "Device state is ready, starting data check timer";
-                }
-            }
-            // If not ready yet, timer will continue checking
-        } else if (d->recordingReady || !d->recording) {
-            // Stop timer if recording is ready or stopped
-            d->readyCheckTimer->stop();
-        }
-    });
-    
-    d->dataCheckTimer = new QTimer(this);
-    d->dataCheckTimer->setSingleShot(false); // Repeat until data appears
-    d->dataCheckTimer->setInterval(50); // Check every 50ms for faster response
-    connect(d->dataCheckTimer, &QTimer::timeout, this, [this]() {
-        if (d->recording && !d->recordingReady && d->audioInput) {
-            int currentBufferSize = d->bufferData.size();
-            // Check if data is actually being written (buffer size increased)
-            if (currentBufferSize > d->bufferSizeWhenReady) {
-                // Data is being written - clear buffer and mark as ready
-                int bytesToClear = currentBufferSize - d->bufferSizeWhenReady;
-                LOG_INFO() << "Data is being written (" << bytesToClear << "bytes), clearing buffer and marking ready";
-                d->bufferData.clear();
-                if (d->bufferDevice) {
-                    d->bufferDevice->close();
-                    d->bufferDevice->open(QIODevice::WriteOnly);
-                }
-                // Now device is really ready - stop timer and emit signal
-                d->dataCheckTimer->stop();
-                d->recordingReady = true;
-                LOG_INFO() << "Recording is ready - data confirmed, buffer cleared, emitting signal";
-                emit recordingReady();
-            }
-            // If no data yet, timer will continue checking
-        } else if (d->recordingReady || !d->recording) {
-            // Stop timer if recording is ready or stopped
-            d->dataCheckTimer->stop();
-        }
-    });
 }
 
 RecordingEngine::~RecordingEngine()
@@ -101,139 +268,186 @@ void RecordingEngine::prepare(const QAudioFormat &requestedFormat)
         return; // Already prepared with the same format
     }
 
-    QAudioDeviceInfo deviceInfo = QAudioDeviceInfo::defaultInputDevice();
-    QAudioFormat format;
-    if (!deviceInfo.isFormatSupported(requestedFormat)) {
-        format = deviceInfo.nearestFormat(requestedFormat);
-    } else {
-        format = requestedFormat;
-    }
-
-    if (format.sampleSize() != 16 || format.sampleType() != QAudioFormat::SignedInt) {
-        format.setSampleSize(16);
-        format.setSampleType(QAudioFormat::SignedInt);
-    }
-    format.setByteOrder(QAudioFormat::LittleEndian);
-    format.setCodec(QStringLiteral("audio/pcm"));
+    const QAudioFormat format = negotiateFormat(QAudioDeviceInfo::defaultInputDevice(), requestedFormat);
 
     // Pre-check device availability and format - this reduces delay later
-    // We don't create QAudioInput here because it can't be reused after stop()
-    // But we cache the format and device info for faster initialization
+    // Without standby we don't create QAudioInput here because it can't be reused
+    // after stop(), but we cache the format for faster initialization
     d->preparedFormat = format;
     d->formatPrepared = true;
     LOG_INFO() << "Audio input device prepared, format:" << format.sampleRate() << "Hz," << format.channelCount() << "ch";
+    if (d->preRollMs > 0 && !d->recording)
+        startStandby();
 }
 
-bool RecordingEngine::startRecording(const QString &filePath, const QAudioFormat &requestedFormat)
+void RecordingEngine::setPreRollMs(int ms)
 {
-    // Stop previous recording if any, but don't reset recordingReady flag yet
-    // We'll reset it after we start new recording
-    if (d->recording) {
-        // Just stop the timer and audio input, but keep recordingReady state
-        if (d->readyCheckTimer) {
-            d->readyCheckTimer->stop();
-        }
-        if (d->audioInput) {
-            d->audioInput->stop();
-        }
-        if (d->bufferDevice) {
-            d->bufferDevice->close();
-        }
-        // Save previous recording if needed
-        if (!d->filePath.isEmpty() && !d->bufferData.isEmpty()) {
-            if (!WavUtils::writeWavFile(d->filePath, d->format, d->bufferData)) {
-                LOG_WARN() << "Failed to write previous recorded WAV to" << d->filePath;
-            }
-        }
-        d->audioInput.reset();
-        d->bufferDevice.reset();
-        d->bufferData.clear();
-        d->filePath.clear();
-        d->recording = false;
-    }
+    ms = qBound(0, ms, kMaxPreRollMs);
+    if (ms == d->preRollMs)
+        return;
+    d->preRollMs = ms;
+    if (d->recording)
+        return; // Applied when the take ends
+    if (ms > 0 && d->formatPrepared)
+        startStandby();
+    else if (ms == 0)
+        stopStandby();
+}
 
-    // Prepare buffer first - this is fast
-    d->bufferData.clear();
-    d->bufferDevice = std::make_unique<QBuffer>(&d->bufferData);
-    if (!d->bufferDevice->open(QIODevice::WriteOnly)) {
-        d->bufferDevice.reset();
-        return false;
-    }
-    d->filePath = filePath;
-    d->recordingReady = false;
-    d->bufferSizeWhenReady = 0;
+int RecordingEngine::preRollMs() const
+{
+    return d->preRollMs;
+}
 
-    // Use prepared format if available and matches, otherwise determine format
-    QAudioDeviceInfo deviceInfo = QAudioDeviceInfo::defaultInputDevice();
-    if (d->formatPrepared && d->preparedFormat == requestedFormat) {
-        // Use pre-prepared format - this should be fast
-        d->format = d->preparedFormat;
-        LOG_INFO() << "Using prepared audio format";
-    } else {
-        // Determine format (slower path)
-        if (!deviceInfo.isFormatSupported(requestedFormat)) {
-            d->format = deviceInfo.nearestFormat(requestedFormat);
-            LOG_WARN() << "Requested format is not supported. Using nearest input format.";
-        } else {
-            d->format = requestedFormat;
-        }
+bool RecordingEngine::isStandbyActive() const
+{
+    return d->standby;
+}
 
-        if (d->format.sampleSize() != 16 || d->format.sampleType() != QAudioFormat::SignedInt) {
-            d->format.setSampleSize(16);
-            d->format.setSampleType(QAudioFormat::SignedInt);
-        }
-        d->format.setByteOrder(QAudioFormat::LittleEndian);
-        d->format.setCodec(QStringLiteral("audio/pcm"));
-    }
+bool RecordingEngine::openInput(const QAudioFormat &format)
+{
+    if (d->readChunk.isEmpty())
+        d->readChunk.resize(64 * 1024);
 
     // Create QAudioInput - this is where delay usually happens
     // But if format was prepared, device info is already known, so it should be faster
-    d->audioInput = std::make_unique<QAudioInput>(deviceInfo, d->format);
-    d->audioInput->setNotifyInterval(100);
+    d->format = format;
+    d->audioInput = std::make_unique<QAudioInput>(QAudioDeviceInfo::defaultInputDevice(), format);
+    d->audioInput->setNotifyInterval(kNotifyIntervalMs);
     connect(d->audioInput.get(), &QAudioInput::stateChanged, this, [this](QAudio::State state) {
         LOG_INFO() << "Audio input state changed to:" << state;
-        if ((state == QAudio::ActiveState || state == QAudio::IdleState) && !d->recordingReady) {
-            // Microphone is now active/idle - but wait for actual data recording
-            // Remember current buffer size (should be 0 or small)
-            d->bufferSizeWhenReady = d->bufferData.size();
-            LOG_INFO() << "Device state is ready, buffer size:" << d->bufferSizeWhenReady << "starting data check";
-            // Stop state check timer, start data check timer
-            if (d->readyCheckTimer) {
-                d->readyCheckTimer->stop();
-            }
-            if (d->dataCheckTimer) {
-                d->dataCheckTimer->start();
-            }
-        }
         if (state == QAudio::StoppedState && d->audioInput->error() != QAudio::NoError) {
             LOG_WARN() << "Recording stopped due to error:" << d->audioInput->error();
         }
     });
+    // notify() covers backends that batch readyRead
+    connect(d->audioInput.get(), &QAudioInput::notify, this, &RecordingEngine::onInputData);
 
-    // Start recording - signal recordingReady() will be emitted when microphone is actually active
-    d->audioInput->start(d->bufferDevice.get());
-    d->recording = true;
-    LOG_INFO() << "Recording initialization started to" << filePath;
-    
-    // Check state immediately - sometimes QAudioInput is already in ActiveState or IdleState
-    QAudio::State currentState = d->audioInput->state();
-    LOG_INFO() << "Initial audio input state:" << currentState;
-    if ((currentState == QAudio::ActiveState || currentState == QAudio::IdleState) && !d->recordingReady) {
-        // Device is in ready state - remember buffer size and start checking for actual data
-        d->bufferSizeWhenReady = d->bufferData.size();
-        LOG_INFO() << "Device state is ready immediately, buffer size:" << d->bufferSizeWhenReady << "starting data check";
-        // Start data check timer to wait for actual data recording
-        if (d->dataCheckTimer) {
-            d->dataCheckTimer->start();
-        }
+    // Pull mode - every period is drained either into the capture ring, which
+    // the writer thread streams to disk, or into the standby pre-roll
+    d->startClock.start();
+    d->inputDevice = d->audioInput->start();
+    if (!d->inputDevice) {
+        LOG_WARN() << "Failed to start audio input:" << d->audioInput->error();
+        d->audioInput.reset();
+        return false;
+    }
+    connect(d->inputDevice, &QIODevice::readyRead, this, &RecordingEngine::onInputData);
+    LOG_INFO() << "Audio input opened, device buffer:" << d->audioInput->bufferSize()
+               << "bytes, period:" << d->audioInput->periodSize() << "bytes";
+    return true;
+}
+
+void RecordingEngine::startStandby()
+{
+    if (d->standby && d->format == d->preparedFormat)
+        return;
+    stopStandby();
+
+    const qint64 frameBytes = d->preparedFormat.channelCount() * (d->preparedFormat.sampleSize() / 8);
+    const qint64 preRollFrames = static_cast<qint64>(d->preparedFormat.sampleRate()) * d->preRollMs / 1000;
+    d->preRoll.reset(qMax<qint64>(frameBytes, preRollFrames * frameBytes));
+    d->standby = openInput(d->preparedFormat);
+    if (d->standby)
+        LOG_INFO() << "Microphone in standby with" << d->preRollMs << "ms pre-roll";
+}
+
+void RecordingEngine::stopStandby()
+{
+    if (!d->standby)
+        return;
+    d->standby = false;
+    if (d->audioInput)
+        d->audioInput->stop();
+    d->inputDevice = nullptr;
+    d->audioInput.reset();
+    d->preRoll.clear();
+    LOG_INFO() << "Microphone standby closed";
+}
+
+bool RecordingEngine::startRecording(const QString &filePath, const QAudioFormat &requestedFormat)
+{
+    // The whole pre-roll leads the take
+    const qint64 preRollFrames = static_cast<qint64>(requestedFormat.sampleRate()) * d->preRollMs / 1000;
+    return startRecording(filePath, requestedFormat, -preRollFrames);
+}
+
+bool RecordingEngine::startRecording(const QString &filePath, const QAudioFormat &requestedFormat, qint64 startOffsetFrames)
+{
+    // Stop previous recording if any; listeners get recordingStopped() for
+    // it before the new take starts
+    if (d->recording) {
+        // A pending tail capture belongs to the previous take, which is
+        // finished exactly as if its stop timer had fired
+        d->stopTimer->stop();
+        finishTake();
+    }
+
+    // Use prepared format if available and matches, otherwise determine format (slower path)
+    QAudioFormat format;
+    if (d->formatPrepared && d->preparedFormat == requestedFormat) {
+        format = d->preparedFormat;
+        LOG_INFO() << "Using prepared audio format";
     } else {
-        // Start timer to check state repeatedly until ready
-        if (d->readyCheckTimer && !d->recordingReady) {
-            d->readyCheckTimer->start();
-            LOG_INFO() << "Started ready check timer - will check every 100ms until ready";
-        }
+        format = negotiateFormat(QAudioDeviceInfo::defaultInputDevice(), requestedFormat);
     }
-    
+    // A standby input in another format would hold the device
+    const bool fromStandby = d->standby && d->audioInput && d->format == format;
+    if (!fromStandby)
+        stopStandby();
+
+    // Open the streaming WAV writer first so no captured period has to wait for it
+    if (!d->writer.start(filePath, format)) {
+        if (!fromStandby && d->preRollMs > 0 && d->formatPrepared)
+            startStandby();
+        return false;
+    }
+    d->filePath = filePath;
+    d->recordingReady = false;
+    d->capturedBytes = 0;
+
+    // The offset is given in frames of the requested format; the device may
+    // run at another rate
+    const qint64 frameBytes = format.channelCount() * (format.sampleSize() / 8);
+    const qint64 offsetFrames = requestedFormat.sampleRate() > 0
+        ? startOffsetFrames * format.sampleRate() / requestedFormat.sampleRate()
+        : 0;
+    d->skipBytes = qMax<qint64>(0, offsetFrames) * frameBytes;
+
+    if (fromStandby) {
+        // Everything up to the click goes to the pre-roll, which becomes the
+        // start of the take; the microphone is known to be live already
+        d->drainInput();
+        const qint64 keptBytes = qMax<qint64>(0, -offsetFrames) * frameBytes;
+        if (d->preRoll.availableToRead() > keptBytes)
+            d->preRoll.skip(d->preRoll.availableToRead() - keptBytes);
+        const qint64 preRollBytes = d->preRoll.availableToRead();
+        qint64 bytes = 0;
+        while ((bytes = d->preRoll.read(d->readChunk.data(), d->readChunk.size())) > 0)
+            d->writer.push(d->readChunk.constData(), bytes);
+        d->recording = true;
+        d->recordingReady = true;
+        LOG_INFO() << "Recording started from standby to" << filePath << "with"
+                   << preRollBytes * 1000 / qMax<qint64>(1, bytesPerSecond(format)) << "ms pre-roll,"
+                   << d->skipBytes * 1000 / qMax<qint64>(1, bytesPerSecond(format)) << "ms skipped";
+        // Queued, so callers finish setting up the take before it is reported live
+        QMetaObject::invokeMethod(this, [this]() {
+            if (d->recording && d->recordingReady)
+                emit recordingReady();
+        }, Qt::QueuedConnection);
+        return true;
+    }
+
+    // recordingReady() is emitted as soon as the first period arrives, i.e.
+    // the microphone is actually live. Without standby the take can only be
+    // anchored to that first period, not to this call.
+    if (!openInput(format)) {
+        d->writer.finish();
+        d->filePath.clear();
+        return false;
+    }
+    d->recording = true;
+    LOG_INFO() << "Recording initialization started to" << filePath;
     return true;
 }
 
@@ -242,14 +456,20 @@ void RecordingEngine::stop()
     if (!d->recording)
         return;
 
-    // Start timer to wait 0.25 seconds before finalizing recording
-    // This captures the "tail" of the recording
-    if (d->stopTimer) {
-        d->stopTimer->start();
-        LOG_INFO() << "Stop requested, waiting 0.25 seconds to capture tail...";
-    } else {
-        // If timer is not available, finalize immediately
-        onStopTimerTimeout();
+    // Wait until what the device still buffers has been delivered, so the
+    // "tail" of the recording is captured
+    const int tailMs = d->tailDelayMs();
+    d->stopTimer->start(tailMs);
+    LOG_INFO() << "Stop requested, waiting" << tailMs << "ms to capture tail...";
+}
+
+void RecordingEngine::onInputData()
+{
+    if (!d->recording && !d->standby)
+        return;
+    if (d->drainInput()) {
+        LOG_INFO() << "Recording is ready - first period arrived after" << d->startClock.elapsed() << "ms";
+        emit recordingReady();
     }
 }
 
@@ -257,46 +477,39 @@ void RecordingEngine::onStopTimerTimeout()
 {
     if (!d->recording)
         return;
+    finishTake();
+}
 
-    // Stop all timers if running
-    if (d->readyCheckTimer) {
-        d->readyCheckTimer->stop();
-    }
-    if (d->dataCheckTimer) {
-        d->dataCheckTimer->stop();
-    }
-
-    // Stop audio input
-    if (d->audioInput)
-        d->audioInput->stop();
-    if (d->bufferDevice)
-        d->bufferDevice->close();
-
-    // Save recording to file
-    if (!d->filePath.isEmpty() && !d->bufferData.isEmpty()) {
-        if (!WavUtils::writeWavFile(d->filePath, d->format, d->bufferData)) {
-            LOG_WARN() << "Failed to write recorded WAV to" << d->filePath;
-        } else {
-            LOG_INFO() << "Recording saved to" << d->filePath << "size:" << d->bufferData.size() << "bytes";
-        }
+void RecordingEngine::finishTake()
+{
+    // Stop audio input and flush the tail of the capture ring to the WAV file.
+    // The file has been written all along, so this only completes the last periods.
+    if (d->finishCapture()) {
+        emit recordingSaved(d->filePath);
+    } else {
+        LOG_WARN() << "Failed to write recorded WAV to" << d->filePath;
     }
 
-    // Always reset audioInput - QAudioInput cannot be reused after stop()
-    // But we keep the prepared format info for faster re-initialization
-    d->audioInput.reset();
-    d->bufferDevice.reset();
-    d->bufferData.clear();
+    // Reset audioInput unless it is the standby one - QAudioInput cannot be
+    // reused after stop(). But we keep the prepared format info for faster re-initialization
+    d->releaseInput();
     d->filePath.clear();
     d->recording = false;
     d->recordingReady = false;
     
     // Re-prepare format for next recording to reduce delay
-    // This doesn't activate microphone, just prepares format info
-    if (d->formatPrepared && d->format.isValid()) {
+    // This doesn't activate microphone, just prepares format info. A standby
+    // keeps the format it was explicitly prepared with.
+    if (d->formatPrepared && d->format.isValid() && d->preRollMs == 0) {
         // Re-prepare with the format we just used
         d->preparedFormat = d->format;
         LOG_INFO() << "Format re-prepared for next recording";
     }
+    // Back to standby, or reopen it if this take needed another format
+    if (d->preRollMs > 0 && d->formatPrepared)
+        startStandby();
+    else
+        stopStandby();
     
     emit recordingStopped();
     LOG_INFO() << "Recording stopped and saved";
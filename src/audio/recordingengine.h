@@ -11,22 +11,46 @@ public:
     ~RecordingEngine() override;
 
     bool startRecording(const QString &filePath, const QAudioFormat &format);
+    // Same, with the take anchored to the call: it begins startOffsetFrames
+    // (in frames of format) after this instant. A negative offset keeps that
+    // much of the standby pre-roll, a positive one drops the first live frames.
+    bool startRecording(const QString &filePath, const QAudioFormat &format, qint64 startOffsetFrames);
     void stop();
     bool isRecording() const;
     
-    // Pre-initialize audio device to reduce delay when starting recording
+    // Pre-initialize audio device to reduce delay when starting recording.
+    // With a pre-roll set this also opens the microphone in hot standby.
     void prepare(const QAudioFormat &format);
 
+    // Hot standby: after prepare() the microphone stays open and the last ms
+    // of input are kept in a ring, so a take in the prepared format starts at
+    // once and begins with that pre-roll. 0 (the default) closes the
+    // microphone between takes.
+    void setPreRollMs(int ms);
+    int preRollMs() const;
+    bool isStandbyActive() const;
+
 signals:
     // Emitted when microphone is ready and recording has actually started
     void recordingReady();
     // Emitted when recording is fully stopped and saved
     void recordingStopped();
+    // Emitted after filePath was (re)written with a finished take
+    void recordingSaved(const QString &filePath);
 
 private slots:
+    void onInputData();
     void onStopTimerTimeout();
 
 private:
+    // Opens the default input in pull mode, wired to onInputData()
+    bool openInput(const QAudioFormat &format);
+    // Saves the current take and emits recordingSaved()/recordingStopped(),
+    // whether it ends through stop() or is pre-empted by a new take
+    void finishTake();
+    void startStandby();
+    void stopStandby();
+
     class Impl;
     Impl *d;
 };
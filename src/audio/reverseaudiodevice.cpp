@@ -0,0 +1,71 @@
+#include "reverseaudiodevice.h"
+
+#include <QtGlobal>
+
+ReverseAudioDevice::ReverseAudioDevice(const AudioView &view, QObject *parent)
+    : QIODevice(parent)
+    , m_view(view)
+    , m_frameCount(view.frameCount())
+{
+    if (m_frameCount > 0)
+        m_frameBytes = view.byteCount() / m_frameCount;
+}
+
+const QAudioFormat &ReverseAudioDevice::format() const
+{
+    return m_view.format();
+}
+
+bool ReverseAudioDevice::isSequential() const
+{
+    return false;
+}
+
+qint64 ReverseAudioDevice::size() const
+{
+    return m_frameCount * m_frameBytes;
+}
+
+char ReverseAudioDevice::reversedByte(qint64 pos) const
+{
+    const qint64 frame = pos / m_frameBytes;
+    const qint64 sourceFrame = m_frameCount - 1 - frame;
+    qint64 available = 0;
+    return *m_view.constData(sourceFrame * m_frameBytes + pos % m_frameBytes, &available);
+}
+
+qint64 ReverseAudioDevice::readData(char *data, qint64 maxlen)
+{
+    qint64 pos = this->pos();
+    const qint64 end = qMin(size(), pos + maxlen);
+    if (pos >= end)
+        return 0;
+
+    char *out = data;
+    // Up to the next frame boundary byte by byte (only after an unaligned seek)
+    while (pos < end && pos % m_frameBytes != 0)
+        *out++ = reversedByte(pos++);
+
+    // Output frames [first, first + count) are source frames
+    // [frameCount - first - count, frameCount - first) reversed
+    const qint64 firstFrame = pos / m_frameBytes;
+    const qint64 wholeFrames = (end - pos) / m_frameBytes;
+    if (wholeFrames > 0) {
+        const char *source = m_view.frames(m_frameCount - firstFrame - wholeFrames, wholeFrames, m_scratch);
+        AudioBuffer::reverseFrames(source, out, wholeFrames, m_view.format());
+        out += wholeFrames * m_frameBytes;
+        pos += wholeFrames * m_frameBytes;
+    }
+
+    while (pos < end)
+        *out++ = reversedByte(pos++);
+
+    return out - data;
+}
+
+qint64 ReverseAudioDevice::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+    return -1;
+}
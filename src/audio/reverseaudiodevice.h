@@ -0,0 +1,34 @@
+#pragma once
+
+#include "audiobuffer.h"
+
+#include <QIODevice>
+
+// Read-only device serving an AudioView back to front. The pages are shared
+// with the buffer, never copied: every read reverses just the
+// requested frames straight into the caller's memory, so reverse playback
+// starts immediately and needs neither a reversed copy nor a temporary file.
+class ReverseAudioDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit ReverseAudioDevice(const AudioView &view, QObject *parent = nullptr);
+
+    const QAudioFormat &format() const;
+
+    bool isSequential() const override;
+    qint64 size() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    // Reversed-stream byte at offset pos, for reads that split a frame
+    char reversedByte(qint64 pos) const;
+
+    AudioView m_view;
+    QByteArray m_scratch; // Frames of a read that straddles two pages
+    qint64 m_frameBytes = 0;
+    qint64 m_frameCount = 0;
+};
@@ -0,0 +1,85 @@
+#include "ringbuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+RingBuffer::RingBuffer(qint64 capacity)
+{
+    reset(capacity);
+}
+
+void RingBuffer::reset(qint64 capacity)
+{
+    m_data.assign(static_cast<size_t>(qMax<qint64>(0, capacity)), 0);
+    clear();
+}
+
+void RingBuffer::clear()
+{
+    m_readPos.store(0, std::memory_order_relaxed);
+    m_writePos.store(0, std::memory_order_relaxed);
+}
+
+qint64 RingBuffer::capacity() const
+{
+    return static_cast<qint64>(m_data.size());
+}
+
+qint64 RingBuffer::write(const char *data, qint64 size)
+{
+    const qint64 capacity = this->capacity();
+    const qint64 writePos = m_writePos.load(std::memory_order_relaxed);
+    const qint64 readPos = m_readPos.load(std::memory_order_acquire);
+    const qint64 toWrite = std::min(size, capacity - (writePos - readPos));
+    if (toWrite <= 0)
+        return 0;
+
+    const qint64 offset = writePos % capacity;
+    const qint64 first = std::min(toWrite, capacity - offset);
+    memcpy(m_data.data() + offset, data, static_cast<size_t>(first));
+    if (toWrite > first)
+        memcpy(m_data.data(), data + first, static_cast<size_t>(toWrite - first));
+
+    m_writePos.store(writePos + toWrite, std::memory_order_release);
+    return toWrite;
+}
+
+qint64 RingBuffer::availableToWrite() const
+{
+    return capacity() - availableToRead();
+}
+
+qint64 RingBuffer::read(char *data, qint64 size)
+{
+    const qint64 capacity = this->capacity();
+    const qint64 readPos = m_readPos.load(std::memory_order_relaxed);
+    const qint64 writePos = m_writePos.load(std::memory_order_acquire);
+    const qint64 toRead = std::min(size, writePos - readPos);
+    if (toRead <= 0)
+        return 0;
+
+    const qint64 offset = readPos % capacity;
+    const qint64 first = std::min(toRead, capacity - offset);
+    memcpy(data, m_data.data() + offset, static_cast<size_t>(first));
+    if (toRead > first)
+        memcpy(data + first, m_data.data(), static_cast<size_t>(toRead - first));
+
+    m_readPos.store(readPos + toRead, std::memory_order_release);
+    return toRead;
+}
+
+qint64 RingBuffer::skip(qint64 size)
+{
+    const qint64 readPos = m_readPos.load(std::memory_order_relaxed);
+    const qint64 writePos = m_writePos.load(std::memory_order_acquire);
+    const qint64 toSkip = std::min(size, writePos - readPos);
+    if (toSkip <= 0)
+        return 0;
+    m_readPos.store(readPos + toSkip, std::memory_order_release);
+    return toSkip;
+}
+
+qint64 RingBuffer::availableToRead() const
+{
+    return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_acquire);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <vector>
+
+// Fixed-size single-producer/single-consumer byte ring. write() and read()
+// may run concurrently on two different threads without locking; everything
+// else must only be called while neither side is active.
+class RingBuffer
+{
+public:
+    explicit RingBuffer(qint64 capacity = 0);
+
+    void reset(qint64 capacity);
+    void clear();
+    qint64 capacity() const;
+
+    // Producer side. Returns the number of bytes stored; what does not fit is dropped.
+    qint64 write(const char *data, qint64 size);
+    qint64 availableToWrite() const;
+
+    // Consumer side.
+    qint64 read(char *data, qint64 size);
+    // Drops up to size of the oldest bytes without copying them
+    qint64 skip(qint64 size);
+    qint64 availableToRead() const;
+
+private:
+    std::vector<char> m_data;
+    // Monotonic byte counters; the difference is the fill level
+    std::atomic<qint64> m_readPos{0};
+    std::atomic<qint64> m_writePos{0};
+};
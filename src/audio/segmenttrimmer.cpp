@@ -0,0 +1,180 @@
+#include "segmenttrimmer.h"
+
+#include "volumeanalyzer.h"
+#include "../utils/logger.h"
+
+#include <QtGlobal>
+
+namespace {
+qint64 bytesPerFrame(const QAudioFormat &format)
+{
+    if (!format.isValid() || format.sampleSize() <= 0)
+        return 0;
+    return (format.sampleSize() / 8) * format.channelCount();
+}
+
+bool hasManualBoundaries(double trimStartMs, double trimEndMs)
+{
+    return trimStartMs >= 0 && trimEndMs >= 0 && trimStartMs < trimEndMs;
+}
+
+TrimRange manualRange(double trimStartMs, double trimEndMs, qint64 sampleRate, qint64 totalFrames)
+{
+    TrimRange range;
+    range.startFrame = qBound<qint64>(0, static_cast<qint64>((trimStartMs * sampleRate) / 1000.0), totalFrames);
+    range.endFrame = qBound<qint64>(0, static_cast<qint64>((trimEndMs * sampleRate) / 1000.0), totalFrames);
+    LOG_INFO() << "Using manual trim boundaries: startMs:" << trimStartMs << "endMs:" << trimEndMs
+               << "startFrame:" << range.startFrame << "endFrame:" << range.endFrame;
+    return range;
+}
+} // namespace
+
+bool TrimRange::isEmpty() const
+{
+    return endFrame <= startFrame;
+}
+
+qint64 TrimRange::frameCount() const
+{
+    return isEmpty() ? 0 : endFrame - startFrame;
+}
+
+SegmentTrimmer::SegmentTrimmer(double noiseThreshold, int windowMs)
+    : m_noiseThreshold(noiseThreshold)
+    , m_windowMs(windowMs)
+{
+}
+
+bool SegmentTrimmer::isQuietWindow(const char *pcm, qint64 startFrame, qint64 frameCount, const QAudioFormat &format) const
+{
+    // Only 16-bit signed integer is measured; like VolumeAnalyzer::analyzeVolume,
+    // other formats read as silence
+    if (format.sampleSize() != 16 || format.sampleType() != QAudioFormat::SignedInt)
+        return m_noiseThreshold > 0.0;
+
+    double rms = 0.0;
+    double peak = 0.0;
+    const qint16 *samples = reinterpret_cast<const qint16 *>(pcm + startFrame * bytesPerFrame(format));
+    VolumeAnalyzer::calculateLevels(samples, frameCount, format.channelCount(), &rms, &peak);
+    return rms < m_noiseThreshold;
+}
+
+TrimRange SegmentTrimmer::detect(const QByteArray &pcm, const QAudioFormat &format) const
+{
+    TrimRange range;
+    const qint64 frameBytes = bytesPerFrame(format);
+    if (frameBytes <= 0 || format.sampleRate() <= 0)
+        return range;
+    const qint64 totalFrames = pcm.size() / frameBytes;
+    range.endFrame = totalFrames;
+
+    const qint64 windowFrames = (static_cast<qint64>(m_windowMs) * format.sampleRate()) / 1000;
+    if (windowFrames <= 0 || totalFrames == 0)
+        return range;
+    const qint64 windowCount = (totalFrames + windowFrames - 1) / windowFrames;
+
+    // Forward scan stops at the first window with sound
+    qint64 first = 0;
+    while (first < windowCount) {
+        const qint64 start = first * windowFrames;
+        if (!isQuietWindow(pcm.constData(), start, qMin(windowFrames, totalFrames - start), format))
+            break;
+        ++first;
+    }
+    if (first == windowCount)
+        return range; // all quiet, keep everything
+
+    // Backward scan stops at the last window with sound, never past the first one
+    qint64 last = windowCount - 1;
+    while (last > first) {
+        const qint64 start = last * windowFrames;
+        if (!isQuietWindow(pcm.constData(), start, qMin(windowFrames, totalFrames - start), format))
+            break;
+        --last;
+    }
+
+    range.startFrame = first * windowFrames;
+    range.endFrame = qMin(totalFrames, (last + 1) * windowFrames);
+    return range;
+}
+
+TrimRange SegmentTrimmer::detect(const VolumeProfile &profile) const
+{
+    TrimRange range;
+    range.endFrame = profile.totalFrames;
+    const QVector<float> &rms = profile.rmsLevels;
+
+    int first = 0;
+    while (first < rms.size() && rms[first] < m_noiseThreshold)
+        ++first;
+    if (first == rms.size())
+        return range; // all quiet, keep everything
+
+    int last = rms.size() - 1;
+    while (last > first && rms[last] < m_noiseThreshold)
+        --last;
+
+    range.startFrame = first * profile.windowFrames;
+    range.endFrame = qMin(profile.totalFrames, (last + 1) * profile.windowFrames);
+    return range;
+}
+
+TrimRange SegmentTrimmer::trim(const QByteArray &pcm, const QAudioFormat &format,
+                               double trimStartMs, double trimEndMs) const
+{
+    const qint64 frameBytes = bytesPerFrame(format);
+    if (pcm.isEmpty() || frameBytes <= 0 || format.sampleRate() <= 0)
+        return TrimRange();
+    const qint64 totalFrames = pcm.size() / frameBytes;
+
+    if (hasManualBoundaries(trimStartMs, trimEndMs))
+        return settle(manualRange(trimStartMs, trimEndMs, format.sampleRate(), totalFrames), totalFrames);
+    return settle(detect(pcm, format), totalFrames);
+}
+
+TrimRange SegmentTrimmer::trim(const VolumeProfile &profile, double trimStartMs, double trimEndMs) const
+{
+    if (profile.totalFrames <= 0 || profile.sampleRate <= 0)
+        return TrimRange();
+
+    if (hasManualBoundaries(trimStartMs, trimEndMs))
+        return settle(manualRange(trimStartMs, trimEndMs, profile.sampleRate, profile.totalFrames), profile.totalFrames);
+    return settle(detect(profile), profile.totalFrames);
+}
+
+TrimRange SegmentTrimmer::settle(TrimRange range, qint64 totalFrames)
+{
+    // Ensure start and end don't overlap
+    if (range.startFrame >= range.endFrame) {
+        if (range.startFrame > 0 && range.endFrame < totalFrames) {
+            // Both were found, but they overlap - use middle point
+            const qint64 middleFrame = (range.startFrame + range.endFrame) / 2;
+            range.startFrame = qMin(range.startFrame, middleFrame);
+            range.endFrame = qMax(range.endFrame, middleFrame + 1);
+            LOG_WARN() << "Start and end overlapped, adjusted to startFrame:" << range.startFrame
+                       << "endFrame:" << range.endFrame;
+        } else {
+            LOG_WARN() << "No valid sound found in segment after trimming, startFrame:"
+                       << range.startFrame << "endFrame:" << range.endFrame;
+            return TrimRange();
+        }
+    }
+
+    LOG_INFO() << "Trimmed segment: original frames:" << totalFrames
+               << "trimmed frames:" << range.frameCount()
+               << "removed from start:" << range.startFrame << "frames"
+               << "removed from end:" << (totalFrames - range.endFrame) << "frames";
+    return range;
+}
+
+QByteArray SegmentTrimmer::copyRange(const QByteArray &pcm, const QAudioFormat &format, const TrimRange &range)
+{
+    const qint64 frameBytes = bytesPerFrame(format);
+    if (frameBytes <= 0 || range.isEmpty())
+        return QByteArray();
+    const qint64 offset = range.startFrame * frameBytes;
+    const qint64 size = qMin<qint64>(range.frameCount() * frameBytes, pcm.size() - offset);
+    if (size <= 0)
+        return QByteArray();
+    return QByteArray(pcm.constData() + offset, static_cast<int>(size));
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QAudioFormat>
+#include <QByteArray>
+
+struct VolumeProfile;
+
+// Half-open frame range [startFrame, endFrame) of a recording
+struct TrimRange
+{
+    qint64 startFrame = 0;
+    qint64 endFrame = 0;
+
+    bool isEmpty() const;
+    qint64 frameCount() const;
+};
+
+// Finds where real sound starts and ends in a recorded segment. Works directly
+// on a PCM view (e.g. WavUtils::WavFileView::pcm()) and measures windows from
+// each end only until the first one at or above the noise threshold, so just
+// the quiet head and tail are scanned and nothing is allocated.
+class SegmentTrimmer
+{
+public:
+    explicit SegmentTrimmer(double noiseThreshold, int windowMs = 100);
+
+    // First and last window whose RMS is not below the threshold. A recording
+    // without such a window is returned whole, like an untrimmed one.
+    TrimRange detect(const QByteArray &pcm, const QAudioFormat &format) const;
+
+    // Manual boundaries (both >= 0, start < end) win over detection. Returns an
+    // empty range when nothing is left to play.
+    TrimRange trim(const QByteArray &pcm, const QAudioFormat &format,
+                   double trimStartMs = -1.0, double trimEndMs = -1.0) const;
+
+    // Same decisions from precomputed window levels (see PcmCache::profile()),
+    // without touching the PCM; the profile's window size is used
+    TrimRange detect(const VolumeProfile &profile) const;
+    TrimRange trim(const VolumeProfile &profile, double trimStartMs = -1.0, double trimEndMs = -1.0) const;
+
+    // Deep copy of range, safe to keep after a mapped pcm view is closed
+    static QByteArray copyRange(const QByteArray &pcm, const QAudioFormat &format, const TrimRange &range);
+
+private:
+    // Resolves overlapping boundaries; empty when no sound is left
+    static TrimRange settle(TrimRange range, qint64 totalFrames);
+    bool isQuietWindow(const char *pcm, qint64 startFrame, qint64 frameCount, const QAudioFormat &format) const;
+
+    double m_noiseThreshold;
+    int m_windowMs;
+};
@@ -1,10 +1,173 @@
 #include "volumeanalyzer.h"
 
 #include <QtGlobal>
+#include <atomic>
 #include <cmath>
 #include <algorithm>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VUD_VOLUME_SSE2 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+// AVX2 is compiled per function and only used after a runtime CPU check
+#define VUD_VOLUME_AVX2 1
+#define VUD_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+#define VUD_VOLUME_AVX2 1
+#define VUD_TARGET_AVX2
+#endif
+#endif
+
 namespace {
+// Integer accumulators of one window: exact sum of squares and largest magnitude
+struct WindowSums
+{
+    quint64 sumSquares = 0;
+    int maxAbs = 0;
+};
+
+using LevelKernel = WindowSums (*)(const qint16 *samples, qint64 frameCount, int channels);
+
+// Reference implementation, handles any channel count
+WindowSums levelsScalar(const qint16 *samples, qint64 frameCount, int channels)
+{
+    WindowSums sums;
+    int minSample = 0;
+    int maxSample = 0;
+    for (qint64 frame = 0; frame < frameCount; ++frame) {
+        const int sample = samples[frame * channels];
+        sums.sumSquares += static_cast<quint32>(sample * sample);
+        minSample = std::min(minSample, sample);
+        maxSample = std::max(maxSample, sample);
+    }
+    sums.maxAbs = std::max(maxSample, -minSample);
+    return sums;
+}
+
+#ifdef VUD_VOLUME_SSE2
+// Mono reads every sample, stereo masks the right channel to zero so madd
+// squares the left sample only. Each 32-bit madd lane can reach 2^31 (two
+// -32768 squares), so lanes are widened as unsigned into 64-bit accumulators.
+WindowSums levelsSse2(const qint16 *samples, qint64 frameCount, int channels)
+{
+    if (channels != 1 && channels != 2)
+        return levelsScalar(samples, frameCount, channels);
+
+    const qint64 sampleCount = frameCount * channels;
+    const qint64 vectorSamples = sampleCount & ~qint64(7);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = channels == 2 ? _mm_set1_epi32(0x0000FFFF) : _mm_set1_epi32(-1);
+    __m128i sum = zero;
+    __m128i minVec = zero;
+    __m128i maxVec = zero;
+    for (qint64 i = 0; i < vectorSamples; i += 8) {
+        const __m128i v = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i)), mask);
+        const __m128i squares = _mm_madd_epi16(v, v);
+        sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(squares, zero));
+        sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(squares, zero));
+        minVec = _mm_min_epi16(minVec, v);
+        maxVec = _mm_max_epi16(maxVec, v);
+    }
+
+    alignas(16) quint64 sumLanes[2];
+    alignas(16) qint16 minLanes[8];
+    alignas(16) qint16 maxLanes[8];
+    _mm_store_si128(reinterpret_cast<__m128i *>(sumLanes), sum);
+    _mm_store_si128(reinterpret_cast<__m128i *>(minLanes), minVec);
+    _mm_store_si128(reinterpret_cast<__m128i *>(maxLanes), maxVec);
+
+    const qint64 vectorFrames = vectorSamples / channels;
+    WindowSums sums = levelsScalar(samples + vectorSamples, frameCount - vectorFrames, channels);
+    sums.sumSquares += sumLanes[0] + sumLanes[1];
+    for (int lane = 0; lane < 8; ++lane)
+        sums.maxAbs = std::max({sums.maxAbs, -int(minLanes[lane]), int(maxLanes[lane])});
+    return sums;
+}
+#endif
+
+#ifdef VUD_VOLUME_AVX2
+VUD_TARGET_AVX2 WindowSums levelsAvx2(const qint16 *samples, qint64 frameCount, int channels)
+{
+    if (channels != 1 && channels != 2)
+        return levelsScalar(samples, frameCount, channels);
+
+    const qint64 sampleCount = frameCount * channels;
+    const qint64 vectorSamples = sampleCount & ~qint64(15);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i mask = channels == 2 ? _mm256_set1_epi32(0x0000FFFF) : _mm256_set1_epi32(-1);
+    __m256i sum = zero;
+    __m256i minVec = zero;
+    __m256i maxVec = zero;
+    for (qint64 i = 0; i < vectorSamples; i += 16) {
+        const __m256i v = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(samples + i)), mask);
+        const __m256i squares = _mm256_madd_epi16(v, v);
+        sum = _mm256_add_epi64(sum, _mm256_unpacklo_epi32(squares, zero));
+        sum = _mm256_add_epi64(sum, _mm256_unpackhi_epi32(squares, zero));
+        minVec = _mm256_min_epi16(minVec, v);
+        maxVec = _mm256_max_epi16(maxVec, v);
+    }
+
+    alignas(32) quint64 sumLanes[4];
+    alignas(32) qint16 minLanes[16];
+    alignas(32) qint16 maxLanes[16];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(sumLanes), sum);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(minLanes), minVec);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(maxLanes), maxVec);
+
+    const qint64 vectorFrames = vectorSamples / channels;
+    WindowSums sums = levelsScalar(samples + vectorSamples, frameCount - vectorFrames, channels);
+    sums.sumSquares += sumLanes[0] + sumLanes[1] + sumLanes[2] + sumLanes[3];
+    for (int lane = 0; lane < 16; ++lane)
+        sums.maxAbs = std::max({sums.maxAbs, -int(minLanes[lane]), int(maxLanes[lane])});
+    return sums;
+}
+
+bool cpuHasAvx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#else
+    return true; // compiled with /arch:AVX2
+#endif
+}
+#endif
+
+VolumeAnalyzer::Kernel resolveKernel(VolumeAnalyzer::Kernel requested)
+{
+#ifdef VUD_VOLUME_AVX2
+    if ((requested == VolumeAnalyzer::Kernel::Auto || requested == VolumeAnalyzer::Kernel::Avx2) && cpuHasAvx2())
+        return VolumeAnalyzer::Kernel::Avx2;
+#endif
+#ifdef VUD_VOLUME_SSE2
+    if (requested != VolumeAnalyzer::Kernel::Scalar)
+        return VolumeAnalyzer::Kernel::Sse2;
+#endif
+    Q_UNUSED(requested);
+    return VolumeAnalyzer::Kernel::Scalar;
+}
+
+LevelKernel kernelFunction(VolumeAnalyzer::Kernel kernel)
+{
+    switch (kernel) {
+#ifdef VUD_VOLUME_AVX2
+    case VolumeAnalyzer::Kernel::Avx2:
+        return levelsAvx2;
+#endif
+#ifdef VUD_VOLUME_SSE2
+    case VolumeAnalyzer::Kernel::Sse2:
+        return levelsSse2;
+#endif
+    default:
+        return levelsScalar;
+    }
+}
+
+std::atomic<VolumeAnalyzer::Kernel> &activeKernel()
+{
+    static std::atomic<VolumeAnalyzer::Kernel> kernel{resolveKernel(VolumeAnalyzer::Kernel::Auto)};
+    return kernel;
+}
+
 qint64 bytesPerSample(const QAudioFormat &format)
 {
     if (!format.isValid())
@@ -25,147 +188,117 @@ qint64 bytesPerFrame(const QAudioFormat &format)
 } // namespace
 
 QVector<VolumeLevel> VolumeAnalyzer::analyzeVolume(
-    const AudioBuffer &buffer,
+    const AudioView &view,
     int windowSizeMs,
     double quietThreshold,
     double loudThreshold)
 {
-    QVector<VolumeLevel> levels;
+    return classify(computeProfile(view, windowSizeMs), quietThreshold, loudThreshold);
+}
+
+VolumeProfile VolumeAnalyzer::computeProfile(const AudioView &view, int windowSizeMs)
+{
+    VolumeProfile profile;
     
-    if (!buffer.format().isValid() || buffer.frameCount() == 0) {
-        return levels;
+    if (!view.format().isValid() || view.frameCount() == 0) {
+        return profile;
     }
     
-    const QAudioFormat &format = buffer.format();
-    const QByteArray &data = buffer.data();
+    const QAudioFormat &format = view.format();
     const qint64 sampleRate = format.sampleRate();
     const int channels = format.channelCount();
     
     if (sampleRate <= 0 || channels <= 0) {
-        return levels;
+        return profile;
     }
     
     // Calculate window size in frames
     const qint64 windowFrames = (windowSizeMs * sampleRate) / 1000;
     if (windowFrames <= 0) {
-        return levels;
+        return profile;
     }
     
-    const qint64 totalFrames = buffer.frameCount();
+    const qint64 totalFrames = view.frameCount();
     const qint64 frameBytes = bytesPerFrame(format);
     
     if (frameBytes <= 0) {
-        return levels;
+        return profile;
     }
+    // Only 16-bit signed integer is measured, other formats report silence
+    const bool isPcm16 = format.sampleSize() == 16 && format.sampleType() == QAudioFormat::SignedInt;
     
-    // Analyze in windows
+    profile.sampleRate = static_cast<int>(sampleRate);
+    profile.windowFrames = windowFrames;
+    profile.totalFrames = totalFrames;
+    const int windowCount = static_cast<int>((totalFrames + windowFrames - 1) / windowFrames);
+    profile.rmsLevels.reserve(windowCount);
+    profile.peakLevels.reserve(windowCount);
+    
+    // Analyze in windows; only the few windows straddling two pages are copied
+    QByteArray scratch;
     for (qint64 startFrame = 0; startFrame < totalFrames; startFrame += windowFrames) {
         const qint64 framesInWindow = qMin(windowFrames, totalFrames - startFrame);
-        const qint64 startByte = startFrame * frameBytes;
-        const qint64 windowBytes = framesInWindow * frameBytes;
         
-        if (startByte + windowBytes > data.size()) {
-            break;
+        double rms = 0.0;
+        double peak = 0.0;
+        if (isPcm16) {
+            calculateLevels(reinterpret_cast<const qint16 *>(view.frames(startFrame, framesInWindow, scratch)),
+                            framesInWindow, channels, &rms, &peak);
         }
-        
-        QByteArray windowData = QByteArray::fromRawData(
-            data.constData() + startByte,
-            static_cast<int>(windowBytes));
-        
+        profile.rmsLevels.append(static_cast<float>(rms));
+        profile.peakLevels.append(static_cast<float>(peak));
+    }
+    
+    return profile;
+}
+
+QVector<VolumeLevel> VolumeAnalyzer::classify(const VolumeProfile &profile, double quietThreshold, double loudThreshold)
+{
+    QVector<VolumeLevel> levels;
+    levels.reserve(profile.rmsLevels.size());
+    for (int i = 0; i < profile.rmsLevels.size(); ++i) {
         VolumeLevel level;
-        level.startFrame = startFrame;
-        level.frameCount = framesInWindow;
-        level.rmsLevel = calculateRMS(windowData, format);
-        level.peakLevel = calculatePeak(windowData, format);
+        level.startFrame = i * profile.windowFrames;
+        level.frameCount = qMin(profile.windowFrames, profile.totalFrames - level.startFrame);
+        level.rmsLevel = profile.rmsLevels[i];
+        level.peakLevel = profile.peakLevels[i];
         level.isQuiet = level.rmsLevel < quietThreshold;
         level.isLoud = level.rmsLevel > loudThreshold;
-        
         levels.append(level);
     }
-    
     return levels;
 }
 
-double VolumeAnalyzer::calculateRMS(const QByteArray &pcmData, const QAudioFormat &format)
+void VolumeAnalyzer::setKernel(Kernel kernel)
 {
-    if (pcmData.isEmpty() || !format.isValid()) {
-        return 0.0;
-    }
-    
-    const int sampleSize = format.sampleSize();
-    const int channels = format.channelCount();
-    
-    if (sampleSize != 16 || format.sampleType() != QAudioFormat::SignedInt) {
-        // Only support 16-bit signed integer for now
-        return 0.0;
-    }
-    
-    const qint16 *samples = reinterpret_cast<const qint16 *>(pcmData.constData());
-    const int sampleCount = pcmData.size() / sizeof(qint16);
-    
-    if (sampleCount == 0) {
-        return 0.0;
-    }
-    
-    double sumSquares = 0.0;
-    int validSamples = 0;
-    
-    // For multi-channel audio, we'll use the first channel or average
-    // For simplicity, let's use first channel
-    for (int i = 0; i < sampleCount; i += channels) {
-        const qint16 sample = samples[i];
-        const double normalized = sampleToFloat(sample);
-        sumSquares += normalized * normalized;
-        validSamples++;
-    }
-    
-    if (validSamples == 0) {
-        return 0.0;
-    }
-    
-    const double rms = std::sqrt(sumSquares / validSamples);
-    return rms;
+    activeKernel().store(resolveKernel(kernel));
 }
 
-double VolumeAnalyzer::calculatePeak(const QByteArray &pcmData, const QAudioFormat &format)
+QString VolumeAnalyzer::kernelName()
 {
-    if (pcmData.isEmpty() || !format.isValid()) {
-        return 0.0;
-    }
-    
-    const int sampleSize = format.sampleSize();
-    const int channels = format.channelCount();
-    
-    if (sampleSize != 16 || format.sampleType() != QAudioFormat::SignedInt) {
-        return 0.0;
-    }
-    
-    const qint16 *samples = reinterpret_cast<const qint16 *>(pcmData.constData());
-    const int sampleCount = pcmData.size() / sizeof(qint16);
-    
-    if (sampleCount == 0) {
-        return 0.0;
-    }
-    
-    double maxAbs = 0.0;
-    
-    // Find peak across all channels
-    for (int i = 0; i < sampleCount; i += channels) {
-        const qint16 sample = samples[i];
-        const double normalized = std::abs(sampleToFloat(sample));
-        if (normalized > maxAbs) {
-            maxAbs = normalized;
-        }
+    switch (activeKernel().load()) {
+    case Kernel::Avx2:
+        return QStringLiteral("avx2");
+    case Kernel::Sse2:
+        return QStringLiteral("sse2");
+    default:
+        return QStringLiteral("scalar");
     }
-    
-    return maxAbs;
 }
 
-double VolumeAnalyzer::sampleToFloat(qint16 sample)
+void VolumeAnalyzer::calculateLevels(const qint16 *samples, qint64 frameCount, int channels,
+                                     double *rmsLevel, double *peakLevel)
 {
-    // Convert 16-bit signed integer (-32768 to 32767) to float (-1.0 to 1.0)
-    // Normalize to -1.0 to 1.0 range
+    // For multi-channel audio only the first channel is measured
+    if (frameCount <= 0 || channels <= 0) {
+        *rmsLevel = 0.0;
+        *peakLevel = 0.0;
+        return;
+    }
+
+    const WindowSums sums = kernelFunction(activeKernel().load())(samples, frameCount, channels);
+    // Convert 16-bit signed integer range to 0.0-1.0
     const double maxValue = 32768.0;
-    return static_cast<double>(sample) / maxValue;
+    *rmsLevel = std::sqrt(static_cast<double>(sums.sumSquares) / frameCount) / maxValue;
+    *peakLevel = sums.maxAbs / maxValue;
 }
-
@@ -2,6 +2,7 @@
 
 #include "audiobuffer.h"
 
+#include <QString>
 #include <QVector>
 #include <QPair>
 
@@ -15,27 +16,51 @@ struct VolumeLevel
     bool isLoud = false;
 };
 
+// Threshold-independent per-window levels of a buffer, normalized to 0.0-1.0.
+// Window i covers frames [i * windowFrames, min((i + 1) * windowFrames, totalFrames)).
+struct VolumeProfile
+{
+    int sampleRate = 0;
+    qint64 windowFrames = 0;
+    qint64 totalFrames = 0;
+    QVector<float> rmsLevels;
+    QVector<float> peakLevels;
+};
+
 class VolumeAnalyzer
 {
 public:
-    // Analyze volume levels in the audio buffer
+    // Implementation of the fused RMS/peak kernel; Auto picks the widest one the CPU supports
+    enum class Kernel
+    {
+        Auto,
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    // Analyze volume levels in the audio view (a whole AudioBuffer converts to one);
+    // frames are reported relative to the start of the view
     // windowSizeMs: size of analysis window in milliseconds (default: 100ms)
     // quietThreshold: RMS level below which is considered quiet (0.0-1.0, default: 0.1)
     // loudThreshold: RMS level above which is considered loud (0.0-1.0, default: 0.7)
     static QVector<VolumeLevel> analyzeVolume(
-        const AudioBuffer &buffer,
+        const AudioView &view,
         int windowSizeMs = 100,
         double quietThreshold = 0.1,
         double loudThreshold = 0.7);
 
-private:
-    // Calculate RMS level for a PCM data chunk
-    static double calculateRMS(const QByteArray &pcmData, const QAudioFormat &format);
-    
-    // Calculate peak level for a PCM data chunk
-    static double calculatePeak(const QByteArray &pcmData, const QAudioFormat &format);
-    
-    // Convert sample value to normalized float (-1.0 to 1.0)
-    static double sampleToFloat(qint16 sample);
-};
+    // Measures every window once; the result can be classified against any thresholds
+    static VolumeProfile computeProfile(const AudioView &view, int windowSizeMs = 100);
+    // Cheap pass over a profile, same result as analyzeVolume() on the profiled buffer
+    static QVector<VolumeLevel> classify(const VolumeProfile &profile, double quietThreshold, double loudThreshold);
+
+    // Forces a kernel (used by benchmarks); unsupported choices fall back to Auto
+    static void setKernel(Kernel kernel);
+    // "avx2", "sse2" or "scalar"
+    static QString kernelName();
 
+    // Single pass over one window of 16-bit first-channel samples: RMS and peak, both normalized to 0.0-1.0
+    static void calculateLevels(const qint16 *samples, qint64 frameCount, int channels,
+                                double *rmsLevel, double *peakLevel);
+};
@@ -0,0 +1,158 @@
+#include "waveformpyramid.h"
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Merges bins [first, last) of a level, weighting the mean square by how many
+// source frames each bin actually covers (only the tail bin can be partial)
+WaveformBin mergeBins(const QVector<WaveformBin> &bins, int first, int last, qint64 window, qint64 totalFrames)
+{
+    WaveformBin merged;
+    merged.minLevel = bins[first].minLevel;
+    merged.maxLevel = bins[first].maxLevel;
+    double weightedSquares = 0.0;
+    qint64 frames = 0;
+    for (int i = first; i < last; ++i) {
+        const WaveformBin &bin = bins[i];
+        merged.minLevel = std::min(merged.minLevel, bin.minLevel);
+        merged.maxLevel = std::max(merged.maxLevel, bin.maxLevel);
+        const qint64 binFrames = std::min(window, totalFrames - i * window);
+        weightedSquares += static_cast<double>(bin.meanSquare) * binFrames;
+        frames += binFrames;
+    }
+    if (frames > 0)
+        merged.meanSquare = static_cast<float>(weightedSquares / frames);
+    return merged;
+}
+} // namespace
+
+float WaveformBin::peakLevel() const
+{
+    return std::max(std::abs(minLevel), std::abs(maxLevel));
+}
+
+float WaveformBin::rmsLevel() const
+{
+    return std::sqrt(meanSquare);
+}
+
+void WaveformPyramid::build(const AudioBuffer &buffer)
+{
+    clear();
+
+    const QAudioFormat &format = buffer.format();
+    if (!format.isValid() || format.sampleSize() != 16 || format.sampleType() != QAudioFormat::SignedInt)
+        return;
+    const int channels = format.channelCount();
+    const qint64 totalFrames = buffer.frameCount();
+    if (channels <= 0 || totalFrames <= 0)
+        return;
+
+    m_frameCount = totalFrames;
+    m_sampleRate = format.sampleRate();
+
+    // Level 0 straight from the samples, first channel only
+    const qint64 baseBins = (totalFrames + kBaseWindowFrames - 1) / kBaseWindowFrames;
+    QVector<WaveformBin> base(static_cast<int>(baseBins));
+    QByteArray scratch;
+    for (qint64 b = 0; b < baseBins; ++b) {
+        const qint64 first = b * kBaseWindowFrames;
+        const qint64 last = std::min(first + kBaseWindowFrames, totalFrames);
+        const qint16 *samples = reinterpret_cast<const qint16 *>(buffer.frames(first, last - first, scratch));
+        qint16 minSample = samples[0];
+        qint16 maxSample = minSample;
+        double sumSquares = 0.0;
+        for (qint64 frame = 0; frame < last - first; ++frame) {
+            const qint16 sample = samples[frame * channels];
+            minSample = std::min(minSample, sample);
+            maxSample = std::max(maxSample, sample);
+            const double normalized = sample / 32768.0;
+            sumSquares += normalized * normalized;
+        }
+        WaveformBin &bin = base[static_cast<int>(b)];
+        bin.minLevel = static_cast<float>(minSample / 32768.0);
+        bin.maxLevel = static_cast<float>(maxSample / 32768.0);
+        bin.meanSquare = static_cast<float>(sumSquares / (last - first));
+    }
+    m_levels.append(base);
+
+    // Each further level halves the bin count until a single bin remains
+    qint64 window = kBaseWindowFrames;
+    while (m_levels.last().size() > 1) {
+        const QVector<WaveformBin> &below = m_levels.last();
+        QVector<WaveformBin> level((below.size() + 1) / 2);
+        for (int i = 0; i < level.size(); ++i)
+            level[i] = mergeBins(below, i * 2, std::min(i * 2 + 2, below.size()), window, totalFrames);
+        window *= 2;
+        m_levels.append(level);
+    }
+}
+
+void WaveformPyramid::clear()
+{
+    m_levels.clear();
+    m_frameCount = 0;
+    m_sampleRate = 0;
+}
+
+bool WaveformPyramid::isEmpty() const
+{
+    return m_levels.isEmpty();
+}
+
+qint64 WaveformPyramid::frameCount() const
+{
+    return m_frameCount;
+}
+
+int WaveformPyramid::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+int WaveformPyramid::levelCount() const
+{
+    return m_levels.size();
+}
+
+qint64 WaveformPyramid::windowFrames(int level) const
+{
+    return kBaseWindowFrames << level;
+}
+
+int WaveformPyramid::levelForColumnFrames(qint64 columnFrames) const
+{
+    int level = 0;
+    while (level + 1 < m_levels.size() && windowFrames(level + 1) <= columnFrames)
+        ++level;
+    return level;
+}
+
+QVector<WaveformBin> WaveformPyramid::summarize(qint64 startFrame, qint64 endFrame, int binCount) const
+{
+    QVector<WaveformBin> result;
+    if (isEmpty() || binCount <= 0)
+        return result;
+
+    startFrame = qBound<qint64>(0, startFrame, m_frameCount);
+    endFrame = qBound<qint64>(0, endFrame, m_frameCount);
+    const qint64 rangeFrames = endFrame - startFrame;
+    if (rangeFrames <= 0)
+        return result;
+
+    const int level = levelForColumnFrames(rangeFrames / binCount);
+    const QVector<WaveformBin> &bins = m_levels[level];
+    const qint64 window = windowFrames(level);
+
+    result.resize(binCount);
+    for (int column = 0; column < binCount; ++column) {
+        const qint64 columnStart = startFrame + (rangeFrames * column) / binCount;
+        const qint64 columnEnd = startFrame + (rangeFrames * (column + 1)) / binCount;
+        const int first = static_cast<int>(columnStart / window);
+        const int last = std::max(first + 1, static_cast<int>((columnEnd + window - 1) / window));
+        result[column] = mergeBins(bins, first, std::min(last, bins.size()), window, m_frameCount);
+    }
+    return result;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "audiobuffer.h"
+
+#include <QVector>
+
+struct WaveformBin
+{
+    float minLevel = 0.0f;   // Lowest sample, normalized to -1.0..1.0
+    float maxLevel = 0.0f;   // Highest sample, normalized to -1.0..1.0
+    float meanSquare = 0.0f; // Mean of squared normalized samples
+
+    float peakLevel() const;
+    float rmsLevel() const;
+};
+
+// Min/max/RMS summary of a buffer at power-of-two window sizes. Level 0 holds
+// one bin per kBaseWindowFrames frames, every next level merges pairs of bins
+// from the one below. Built once per buffer, then any frame range can be
+// summarized into N pixel columns in O(N) regardless of the source length.
+// Like VolumeAnalyzer, only the first channel of 16-bit PCM is considered.
+class WaveformPyramid
+{
+public:
+    static constexpr qint64 kBaseWindowFrames = 256;
+
+    void build(const AudioBuffer &buffer);
+    void clear();
+    bool isEmpty() const;
+
+    qint64 frameCount() const;
+    int sampleRate() const;
+    int levelCount() const;
+    qint64 windowFrames(int level) const;
+
+    // Summarizes [startFrame, endFrame) into binCount equal columns, reading
+    // the coarsest level whose window still fits into one column
+    QVector<WaveformBin> summarize(qint64 startFrame, qint64 endFrame, int binCount) const;
+
+private:
+    int levelForColumnFrames(qint64 columnFrames) const;
+
+    QVector<QVector<WaveformBin>> m_levels;
+    qint64 m_frameCount = 0;
+    int m_sampleRate = 0;
+};
@@ -1,216 +1,516 @@
 #include "wavutils.h"
 
-#include <QDataStream>
 #include <QFile>
 #include <QtEndian>
+#include <cstring>
+#include <limits>
 
+#include "audiobuffer.h"
 #include "../utils/logger.h"
 
 namespace {
 
 constexpr int kWavHeaderSize = 44;
 
+// Header written by WavWriter: RIFF + JUNK(28, reserved for ds64) + fmt + data
+constexpr int kJunkChunkOffset = 12;
+constexpr int kDs64BodySize = 28;
+constexpr int kDataSizeOffset = kJunkChunkOffset + 8 + kDs64BodySize + 8 + 16 + 4;
+constexpr int kStreamingHeaderSize = kDataSizeOffset + 4;
+constexpr qint64 kRiffSizeLimit = 0xFFFFFFFFLL;
+constexpr qint64 kByteArrayLimit = std::numeric_limits<int>::max();
+
+bool fail(const QString &filePath, const QString &err, const char *logMessage, QString *errorString)
+{
+    if (errorString)
+        *errorString = err;
+    LOG_WARN() << logMessage << filePath;
+    return false;
 }
 
-namespace WavUtils {
+bool failTooLarge(const QString &filePath, qint64 pcmSize, QString *errorString)
+{
+    LOG_WARN() << "WAV PCM of" << pcmSize << "bytes does not fit in memory as one block";
+    return fail(filePath, QObject::tr("WAV-файл слишком большой для загрузки целиком (больше 2 ГБ)."),
+                "WAV file too large:", errorString);
+}
 
-bool readWavFile(const QString &filePath, QByteArray &pcmData, QAudioFormat &format, QString *errorString)
+struct WavLayout
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        const QString err = QObject::tr("Не удалось открыть WAV-файл: %1").arg(file.errorString());
-        if (errorString)
-            *errorString = err;
-        LOG_WARN() << "Failed to open WAV file:" << filePath << err;
-        return false;
+    quint16 audioFormat = 0;
+    quint16 channelCount = 0;
+    quint32 sampleRate = 0;
+    quint16 bitsPerSample = 0;
+    qint64 dataOffset = 0;
+    qint64 dataSize = 0;
+};
+
+// Walks the RIFF chunk list of an in-memory WAV image and locates fmt and data
+bool parseWavLayout(const uchar *bytes, qint64 size, const QString &filePath, WavLayout &layout, QString *errorString)
+{
+    if (size < 12) {
+        return fail(filePath, QObject::tr("WAV-файл поврежден или имеет неполный заголовок."),
+                    "Invalid WAV header in", errorString);
+    }
+    const bool rf64 = memcmp(bytes, "RF64", 4) == 0;
+    if ((!rf64 && memcmp(bytes, "RIFF", 4) != 0) || memcmp(bytes + 8, "WAVE", 4) != 0) {
+        return fail(filePath, QObject::tr("Файл не является корректным WAV (отсутствует подпись RIFF/WAVE)."),
+                    "Not a valid RIFF/WAVE file:", errorString);
+    }
+
+    bool fmtFound = false;
+    bool dataFound = false;
+    qint64 ds64DataSize = -1;
+    qint64 pos = 12;
+    while (pos + 8 <= size) {
+        const uchar *chunk = bytes + pos;
+        const qint64 chunkSize = qFromLittleEndian<quint32>(chunk + 4);
+        const qint64 bodyOffset = pos + 8;
+        const qint64 available = size - bodyOffset;
+
+        if (rf64 && memcmp(chunk, "ds64", 4) == 0 && available >= 16) {
+            // RF64 keeps the real 64-bit sizes here; the 32-bit fields hold 0xFFFFFFFF
+            ds64DataSize = static_cast<qint64>(qFromLittleEndian<quint64>(bytes + bodyOffset + 8));
+        } else if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunkSize < 16 || available < 16) {
+                return fail(filePath, QObject::tr("WAV-файл поврежден (неполные данные fmt)."),
+                            "Incomplete fmt data in WAV:", errorString);
+            }
+            const uchar *fmt = bytes + bodyOffset;
+            layout.audioFormat = qFromLittleEndian<quint16>(fmt);
+            layout.channelCount = qFromLittleEndian<quint16>(fmt + 2);
+            layout.sampleRate = qFromLittleEndian<quint32>(fmt + 4);
+            layout.bitsPerSample = qFromLittleEndian<quint16>(fmt + 14);
+            fmtFound = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            layout.dataOffset = bodyOffset;
+            const qint64 dataSize = (chunkSize == kRiffSizeLimit && ds64DataSize >= 0) ? ds64DataSize : chunkSize;
+            // A zero or oversized length means the writer never patched the header
+            // (e.g. the recording was interrupted); take everything that is there
+            layout.dataSize = (dataSize == 0 || dataSize > available) ? available : dataSize;
+            dataFound = true;
+            break;
+        }
+        // Skip to next chunk (chunk size + padding if odd)
+        pos = bodyOffset + chunkSize + (chunkSize & 1);
     }
 
-    // Read RIFF header
-    QByteArray riffHeader = file.read(12);
-    if (riffHeader.size() < 12) {
-        const QString err = QObject::tr("WAV-файл поврежден или имеет неполный заголовок.");
+    if (!fmtFound) {
+        return fail(filePath, QObject::tr("WAV-файл не содержит блока fmt."),
+                    "Missing fmt chunk in WAV:", errorString);
+    }
+    const bool pcm16 = layout.audioFormat == 1 && layout.bitsPerSample == 16;
+    const bool float32 = layout.audioFormat == 3 && layout.bitsPerSample == 32;
+    if ((!pcm16 && !float32) || layout.channelCount == 0) {
+        const QString err = QObject::tr("Формат WAV не поддерживается (код %1, %2 бит).").arg(layout.audioFormat).arg(layout.bitsPerSample);
         if (errorString)
             *errorString = err;
-        LOG_WARN() << "Invalid WAV header in" << filePath;
+        LOG_WARN() << "Unsupported WAV format:" << filePath << "format" << layout.audioFormat << "bits" << layout.bitsPerSample;
         return false;
     }
+    if (!dataFound) {
+        return fail(filePath, QObject::tr("В WAV-файле отсутствует блок PCM-данных."),
+                    "WAV data chunk not found:", errorString);
+    }
+    if (layout.dataSize <= 0) {
+        return fail(filePath, QObject::tr("Не удалось прочитать PCM-данные из WAV."),
+                    "Empty PCM data in WAV:", errorString);
+    }
+    return true;
+}
+
+QByteArray floatToPcm16(const uchar *data, qint64 size)
+{
+    const int sampleCount = static_cast<int>(size / static_cast<qint64>(sizeof(float)));
+    QByteArray pcm16(sampleCount * static_cast<int>(sizeof(qint16)), Qt::Uninitialized);
+    qint16 *dst = reinterpret_cast<qint16 *>(pcm16.data());
+    for (int i = 0; i < sampleCount; ++i) {
+        float sample;
+        memcpy(&sample, data + i * sizeof(float), sizeof(float));
+        if (sample > 1.0f)
+            sample = 1.0f;
+        else if (sample < -1.0f)
+            sample = -1.0f;
+        dst[i] = static_cast<qint16>(sample * 32767.0f);
+    }
+    return pcm16;
+}
+
+} // namespace
+
+namespace WavUtils {
+
+WavFileView::WavFileView() = default;
+
+WavFileView::~WavFileView()
+{
+    close();
+}
 
-    const char *hdr = riffHeader.constData();
-    if (memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0) {
-        const QString err = QObject::tr("Файл не является корректным WAV (отсутствует подпись RIFF/WAVE).");
+bool WavFileView::open(const QString &filePath, QString *errorString)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        const QString err = QObject::tr("Не удалось открыть WAV-файл: %1").arg(m_file.errorString());
         if (errorString)
             *errorString = err;
-        LOG_WARN() << "Not a valid RIFF/WAVE file:" << filePath;
+        LOG_WARN() << "Failed to open WAV file:" << filePath << err;
         return false;
     }
 
-    // Read fmt chunk
-    QByteArray fmtChunkId = file.read(4);
-    if (fmtChunkId.size() < 4 || memcmp(fmtChunkId.constData(), "fmt ", 4) != 0) {
-        const QString err = QObject::tr("WAV-файл не содержит блока fmt.");
-        if (errorString)
-            *errorString = err;
-        LOG_WARN() << "Missing fmt chunk in WAV:" << filePath;
+    const qint64 fileSize = m_file.size();
+    const uchar *bytes = nullptr;
+    if (fileSize > 0)
+        m_map = m_file.map(0, fileSize);
+    if (m_map) {
+        bytes = m_map;
+    } else {
+        // Mapping is not available for every file (e.g. Qt resources); fall back to one read
+        m_owned = m_file.readAll();
+        bytes = reinterpret_cast<const uchar *>(m_owned.constData());
+    }
+
+    WavLayout layout;
+    if (!parseWavLayout(bytes, m_map ? fileSize : m_owned.size(), filePath, layout, errorString)) {
+        close();
         return false;
     }
 
-    QByteArray fmtSizeBytes = file.read(4);
-    if (fmtSizeBytes.size() < 4) {
-        const QString err = QObject::tr("WAV-файл поврежден (неполный блок fmt).");
+    if (layout.audioFormat == 3) {
+        // 32-bit float is converted to 16-bit PCM once; this is the only copying path
+        if (layout.dataSize / 2 > kByteArrayLimit) {
+            failTooLarge(filePath, layout.dataSize / 2, errorString);
+            close();
+            return false;
+        }
+        m_owned = floatToPcm16(bytes + layout.dataOffset, layout.dataSize);
+        m_pcm = m_owned.constData();
+        m_pcmSize = m_owned.size();
+        if (m_map) {
+            m_file.unmap(m_map);
+            m_map = nullptr;
+        }
+    } else {
+        m_pcm = reinterpret_cast<const char *>(bytes + layout.dataOffset);
+        m_pcmSize = layout.dataSize;
+    }
+
+    m_format = QAudioFormat();
+    m_format.setChannelCount(layout.channelCount);
+    m_format.setSampleRate(static_cast<int>(layout.sampleRate));
+    m_format.setSampleSize(16);
+    m_format.setSampleType(QAudioFormat::SignedInt);
+    m_format.setCodec(QStringLiteral("audio/pcm"));
+    m_format.setByteOrder(QAudioFormat::LittleEndian);
+    return true;
+}
+
+void WavFileView::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    if (m_file.isOpen())
+        m_file.close();
+    m_owned.clear();
+    m_pcm = nullptr;
+    m_pcmSize = 0;
+    m_format = QAudioFormat();
+}
+
+bool WavFileView::isOpen() const
+{
+    return m_pcm != nullptr;
+}
+
+bool WavFileView::isMapped() const
+{
+    return m_map != nullptr;
+}
+
+const QAudioFormat &WavFileView::format() const
+{
+    return m_format;
+}
+
+const char *WavFileView::pcmData() const
+{
+    return m_pcm;
+}
+
+qint64 WavFileView::pcmSize() const
+{
+    return m_pcmSize;
+}
+
+bool WavFileView::fitsByteArray(QString *errorString) const
+{
+    if (m_pcmSize <= kByteArrayLimit)
+        return true;
+    if (errorString)
+        failTooLarge(m_file.fileName(), m_pcmSize, errorString);
+    return false;
+}
+
+QByteArray WavFileView::pcm() const
+{
+    if (!m_pcm || !fitsByteArray())
+        return {};
+    return QByteArray::fromRawData(m_pcm, static_cast<int>(m_pcmSize));
+}
+
+QByteArray WavFileView::detachedPcm() const
+{
+    if (!m_pcm || !fitsByteArray())
+        return {};
+    if (m_pcm == m_owned.constData() && m_pcmSize == m_owned.size())
+        return m_owned;
+    return QByteArray(m_pcm, static_cast<int>(m_pcmSize));
+}
+
+AudioBuffer WavFileView::audio() const
+{
+    AudioBuffer buffer;
+    buffer.setFormat(m_format);
+    const qint64 frameBytes = m_format.bytesPerFrame();
+    if (!m_pcm || frameBytes <= 0)
+        return buffer;
+    const qint64 pageBytes = (AudioBuffer::kPageBytes / frameBytes) * frameBytes;
+    for (qint64 offset = 0; offset < m_pcmSize; offset += pageBytes) {
+        const qint64 size = qMin(pageBytes, m_pcmSize - offset);
+        buffer.appendPage(QByteArray::fromRawData(m_pcm + offset, static_cast<int>(size)));
+    }
+    return buffer;
+}
+
+AudioBuffer WavFileView::detachedAudio() const
+{
+    AudioBuffer buffer;
+    buffer.setFormat(m_format);
+    if (!m_pcm)
+        return buffer;
+    // Converted float PCM is already a copy of its own
+    if (m_pcm == m_owned.constData() && m_pcmSize == m_owned.size())
+        buffer.setData(m_owned);
+    else
+        buffer.append(m_pcm, m_pcmSize);
+    return buffer;
+}
+
+bool readWavFile(const QString &filePath, QByteArray &pcmData, QAudioFormat &format, QString *errorString)
+{
+    WavFileView view;
+    if (!view.open(filePath, errorString) || !view.fitsByteArray(errorString))
+        return false;
+
+    pcmData = view.detachedPcm();
+    format = view.format();
+
+    LOG_INFO() << "WAV loaded:" << filePath << "channels" << format.channelCount() << "rate" << format.sampleRate();
+    return true;
+}
+
+WavWriter::WavWriter() = default;
+
+WavWriter::~WavWriter()
+{
+    if (m_file.isOpen())
+        finalize();
+}
+
+bool WavWriter::open(const QString &filePath, const QAudioFormat &format, QString *errorString)
+{
+    if (m_file.isOpen())
+        discard();
+
+    if (!format.isValid() || format.sampleSize() != 16 || format.sampleType() != QAudioFormat::SignedInt) {
+        const QString err = QObject::tr("Для записи WAV требуется 16-битный PCM.");
         if (errorString)
             *errorString = err;
-        LOG_WARN() << "Incomplete fmt chunk in WAV:" << filePath;
+        LOG_WARN() << "Attempted to write WAV with unsupported format:" << filePath;
         return false;
     }
 
-    quint32 fmtSize = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(fmtSizeBytes.constData()));
-    QByteArray fmtData = file.read(fmtSize);
-    if (fmtData.size() < 16) {
-        const QString err = QObject::tr("WAV-файл поврежден (неполные данные fmt).");
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        const QString err = QObject::tr("Не удалось открыть файл для записи: %1").arg(m_file.errorString());
         if (errorString)
             *errorString = err;
-        LOG_WARN() << "Incomplete fmt data in WAV:" << filePath;
+        LOG_WARN() << "Failed to write WAV file:" << filePath << err;
         return false;
     }
 
-    const uchar *fmt = reinterpret_cast<const uchar *>(fmtData.constData());
-    quint16 audioFormat = qFromLittleEndian<quint16>(fmt);
-    quint16 channelCount = qFromLittleEndian<quint16>(fmt + 2);
-    quint32 sampleRate = qFromLittleEndian<quint32>(fmt + 4);
-    quint16 bitsPerSample = qFromLittleEndian<quint16>(fmt + 14);
+    m_format = format;
+    m_dataSize = 0;
+    m_failed = false;
+
+    // Placeholder header; sizes are patched by finalize()
+    const quint16 blockAlign = static_cast<quint16>(format.channelCount() * (format.sampleSize() / 8));
+    const quint32 byteRate = static_cast<quint32>(format.sampleRate()) * blockAlign;
+    QByteArray header(kStreamingHeaderSize, '\0');
+    uchar *h = reinterpret_cast<uchar *>(header.data());
+    memcpy(h, "RIFF", 4);
+    memcpy(h + 8, "WAVE", 4);
+    memcpy(h + kJunkChunkOffset, "JUNK", 4);
+    qToLittleEndian<quint32>(kDs64BodySize, h + kJunkChunkOffset + 4);
+    uchar *fmt = h + kJunkChunkOffset + 8 + kDs64BodySize;
+    memcpy(fmt, "fmt ", 4);
+    qToLittleEndian<quint32>(16, fmt + 4); // PCM chunk size
+    qToLittleEndian<quint16>(1, fmt + 8); // PCM format
+    qToLittleEndian<quint16>(static_cast<quint16>(format.channelCount()), fmt + 10);
+    qToLittleEndian<quint32>(static_cast<quint32>(format.sampleRate()), fmt + 12);
+    qToLittleEndian<quint32>(byteRate, fmt + 16);
+    qToLittleEndian<quint16>(blockAlign, fmt + 20);
+    qToLittleEndian<quint16>(static_cast<quint16>(format.sampleSize()), fmt + 22);
+    memcpy(h + kDataSizeOffset - 4, "data", 4);
 
-    if ((audioFormat != 1 && audioFormat != 3) || (bitsPerSample != 16 && bitsPerSample != 32)) {
-        const QString err = QObject::tr("Формат WAV не поддерживается (код %1, %2 бит).").arg(audioFormat).arg(bitsPerSample);
+    if (m_file.write(header) != header.size()) {
+        const QString err = QObject::tr("Ошибка при записи PCM-данных в WAV.");
         if (errorString)
             *errorString = err;
-        LOG_WARN() << "Unsupported WAV format:" << filePath << "format" << audioFormat << "bits" << bitsPerSample;
+        LOG_WARN() << "Failed to write WAV header:" << filePath;
+        discard();
         return false;
     }
+    return true;
+}
 
-    // Skip any extra fmt data or other chunks before data
-    if (fmtSize > 16) {
-        file.seek(file.pos() + (fmtSize - 16));
+bool WavWriter::append(const char *data, qint64 size)
+{
+    if (!m_file.isOpen() || m_failed)
+        return false;
+    if (size <= 0)
+        return true;
+    if (m_file.write(data, size) != size) {
+        m_failed = true;
+        LOG_WARN() << "Failed to write PCM data for WAV:" << m_file.fileName();
+        return false;
     }
+    m_dataSize += size;
+    return true;
+}
 
-    // Find data chunk
-    QByteArray chunkId;
-    quint32 chunkSize = 0;
-    while (!file.atEnd()) {
-        chunkId = file.read(4);
-        if (chunkId.size() < 4)
-            break;
-        QByteArray sizeBytes = file.read(4);
-        if (sizeBytes.size() < 4)
-            break;
-        chunkSize = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(sizeBytes.constData()));
-        if (chunkId == "data")
-            break;
-        // Skip to next chunk (chunk size + padding if odd)
-        file.seek(file.pos() + chunkSize + (chunkSize & 1));
+bool WavWriter::append(const QByteArray &pcm)
+{
+    return append(pcm.constData(), pcm.size());
+}
+
+bool WavWriter::append(const AudioView &view)
+{
+    for (qint64 offset = 0; offset < view.byteCount();) {
+        qint64 available = 0;
+        const char *data = view.constData(offset, &available);
+        if (!append(data, available))
+            return false;
+        offset += available;
     }
+    return true;
+}
 
-    if (chunkId != "data") {
-        const QString err = QObject::tr("В WAV-файле отсутствует блок PCM-данных.");
-        if (errorString)
-            *errorString = err;
-        LOG_WARN() << "WAV data chunk not found:" << filePath;
+bool WavWriter::finalize(QString *errorString)
+{
+    if (!m_file.isOpen())
         return false;
+
+    const QString filePath = m_file.fileName();
+    bool ok = !m_failed;
+    if (ok && (m_dataSize & 1))
+        ok = m_file.write("\0", 1) == 1; // RIFF chunks are word aligned
+
+    const qint64 riffSize = kStreamingHeaderSize - 8 + m_dataSize + (m_dataSize & 1);
+    if (ok && riffSize <= kRiffSizeLimit) {
+        uchar size32[4];
+        qToLittleEndian<quint32>(static_cast<quint32>(riffSize), size32);
+        ok = m_file.seek(4) && m_file.write(reinterpret_cast<const char *>(size32), 4) == 4;
+        qToLittleEndian<quint32>(static_cast<quint32>(m_dataSize), size32);
+        ok = ok && m_file.seek(kDataSizeOffset) && m_file.write(reinterpret_cast<const char *>(size32), 4) == 4;
+    } else if (ok) {
+        // Past 4 GiB: promote to RF64, turning the reserved JUNK chunk into ds64
+        const int frameBytes = m_format.channelCount() * (m_format.sampleSize() / 8);
+        uchar ds64[8 + kDs64BodySize];
+        memcpy(ds64, "ds64", 4);
+        qToLittleEndian<quint32>(kDs64BodySize, ds64 + 4);
+        qToLittleEndian<quint64>(static_cast<quint64>(riffSize), ds64 + 8);
+        qToLittleEndian<quint64>(static_cast<quint64>(m_dataSize), ds64 + 16);
+        qToLittleEndian<quint64>(static_cast<quint64>(frameBytes > 0 ? m_dataSize / frameBytes : 0), ds64 + 24);
+        qToLittleEndian<quint32>(0, ds64 + 32); // no extra size table entries
+        uchar marker[4];
+        qToLittleEndian<quint32>(0xFFFFFFFFu, marker);
+        ok = m_file.seek(0) && m_file.write("RF64", 4) == 4
+            && m_file.write(reinterpret_cast<const char *>(marker), 4) == 4
+            && m_file.seek(kJunkChunkOffset) && m_file.write(reinterpret_cast<const char *>(ds64), sizeof(ds64)) == qint64(sizeof(ds64))
+            && m_file.seek(kDataSizeOffset) && m_file.write(reinterpret_cast<const char *>(marker), 4) == 4;
+        if (ok)
+            LOG_INFO() << "WAV promoted to RF64:" << filePath << "bytes" << m_dataSize;
     }
+    m_file.close();
 
-    QByteArray data = file.read(chunkSize);
-    if (data.isEmpty()) {
-        const QString err = QObject::tr("Не удалось прочитать PCM-данные из WAV.");
+    if (!ok) {
+        const QString err = QObject::tr("Ошибка при записи PCM-данных в WAV.");
         if (errorString)
             *errorString = err;
-        LOG_WARN() << "Empty PCM data in WAV:" << filePath;
+        LOG_WARN() << "Failed to finalize WAV:" << filePath;
         return false;
     }
+    LOG_INFO() << "WAV written:" << filePath << "bytes" << m_dataSize;
+    return true;
+}
 
-    if (audioFormat == 3 && bitsPerSample == 32) {
-        const int sampleCount = data.size() / static_cast<int>(sizeof(float));
-        const float *floatSamples = reinterpret_cast<const float *>(data.constData());
-        QByteArray pcm16(sampleCount * static_cast<int>(sizeof(qint16)), Qt::Uninitialized);
-        qint16 *dst = reinterpret_cast<qint16 *>(pcm16.data());
-        for (int i = 0; i < sampleCount; ++i) {
-            float sample = floatSamples[i];
-            if (sample > 1.0f)
-                sample = 1.0f;
-            else if (sample < -1.0f)
-                sample = -1.0f;
-            dst[i] = static_cast<qint16>(sample * 32767.0f);
-        }
-        pcmData = pcm16;
-        bitsPerSample = 16;
-        audioFormat = 1;
-    } else {
-        pcmData = data;
-    }
+void WavWriter::discard()
+{
+    if (!m_file.isOpen())
+        return;
+    m_file.close();
+    m_file.remove();
+    m_dataSize = 0;
+}
 
-    format.setChannelCount(channelCount);
-    format.setSampleRate(sampleRate);
-    format.setSampleSize(16);
-    format.setSampleType(QAudioFormat::SignedInt);
-    format.setCodec(QStringLiteral("audio/pcm"));
-    format.setByteOrder(QAudioFormat::LittleEndian);
+bool WavWriter::isOpen() const
+{
+    return m_file.isOpen();
+}
 
-    LOG_INFO() << "WAV loaded:" << filePath << "channels" << channelCount << "rate" << sampleRate;
-    return true;
+qint64 WavWriter::dataSize() const
+{
+    return m_dataSize;
+}
+
+const QAudioFormat &WavWriter::format() const
+{
+    return m_format;
 }
 
 bool writeWavFile(const QString &filePath, const QAudioFormat &format, const QByteArray &pcmData, QString *errorString)
 {
-    if (!format.isValid() || format.sampleSize() != 16 || format.sampleType() != QAudioFormat::SignedInt) {
-        const QString err = QObject::tr("Для записи WAV требуется 16-битный PCM.");
-        if (errorString)
-            *errorString = err;
-        LOG_WARN() << "Attempted to write WAV with unsupported format:" << filePath;
+    WavWriter writer;
+    if (!writer.open(filePath, format, errorString))
         return false;
-    }
-
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        const QString err = QObject::tr("Не удалось открыть файл для записи: %1").arg(file.errorString());
+    if (!writer.append(pcmData)) {
+        const QString err = QObject::tr("Ошибка при записи PCM-данных в WAV.");
         if (errorString)
             *errorString = err;
-        LOG_WARN() << "Failed to write WAV file:" << filePath << err;
+        writer.discard();
         return false;
     }
+    return writer.finalize(errorString);
+}
 
-    QDataStream stream(&file);
-    stream.setByteOrder(QDataStream::LittleEndian);
-
-    const quint32 dataSize = static_cast<quint32>(pcmData.size());
-    const quint32 riffSize = dataSize + 36;
-
-    stream.writeRawData("RIFF", 4);
-    stream << riffSize;
-    stream.writeRawData("WAVE", 4);
-    stream.writeRawData("fmt ", 4);
-    stream << quint32(16); // PCM chunk size
-    stream << quint16(1); // PCM format
-    stream << quint16(format.channelCount());
-    stream << quint32(format.sampleRate());
-    const quint32 byteRate = format.sampleRate() * format.channelCount() * (format.sampleSize() / 8);
-    const quint16 blockAlign = format.channelCount() * (format.sampleSize() / 8);
-    stream << byteRate;
-    stream << blockAlign;
-    stream << quint16(format.sampleSize());
-    stream.writeRawData("data", 4);
-    stream << dataSize;
-
-    if (stream.writeRawData(pcmData.constData(), pcmData.size()) != pcmData.size()) {
+bool writeWavFile(const QString &filePath, const AudioView &view, QString *errorString)
+{
+    WavWriter writer;
+    if (!writer.open(filePath, view.format(), errorString))
+        return false;
+    if (!writer.append(view)) {
         const QString err = QObject::tr("Ошибка при записи PCM-данных в WAV.");
         if (errorString)
             *errorString = err;
-        LOG_WARN() << "Failed to write PCM data for WAV:" << filePath;
+        writer.discard();
         return false;
     }
-
-    file.close();
-    LOG_INFO() << "WAV written:" << filePath << "bytes" << dataSize;
-    return true;
+    return writer.finalize(errorString);
 }
 
 } // namespace WavUtils
-
-
@@ -2,11 +2,95 @@
 
 #include <QAudioFormat>
 #include <QByteArray>
+#include <QFile>
 #include <QString>
 
+class AudioBuffer;
+class AudioView;
+
 namespace WavUtils {
 
+// Read-only view of the PCM payload of a WAV file. 16-bit PCM files are
+// memory-mapped and served straight from the page cache without a heap copy;
+// 32-bit float files are converted to 16-bit PCM once on open.
+class WavFileView
+{
+public:
+    WavFileView();
+    ~WavFileView();
+
+    WavFileView(const WavFileView &) = delete;
+    WavFileView &operator=(const WavFileView &) = delete;
+
+    bool open(const QString &filePath, QString *errorString = nullptr);
+    void close();
+
+    bool isOpen() const;
+    // True when pcmData() points into the file mapping
+    bool isMapped() const;
+
+    const QAudioFormat &format() const;
+    const char *pcmData() const;
+    qint64 pcmSize() const;
+
+    // False, with errorString set, when the PCM is over the 2 GiB a single
+    // QByteArray holds; pcm() and detachedPcm() are empty then
+    bool fitsByteArray(QString *errorString = nullptr) const;
+    // Non-owning QByteArray over the PCM (QByteArray::fromRawData), valid until close()
+    QByteArray pcm() const;
+    // Owning copy of the PCM that outlives the view
+    QByteArray detachedPcm() const;
+    // The PCM as buffer pages over the mapping, of any size and without a
+    // copy; valid until close()
+    AudioBuffer audio() const;
+    // Owning paged copy of the PCM that outlives the view, of any size
+    AudioBuffer detachedAudio() const;
+
+private:
+    QFile m_file;
+    uchar *m_map = nullptr;
+    QByteArray m_owned;
+    QAudioFormat m_format;
+    const char *m_pcm = nullptr;
+    qint64 m_pcmSize = 0;
+};
+
+// Streaming 16-bit PCM WAV writer: open() writes a placeholder header, append()
+// streams PCM chunks to disk and finalize() patches the RIFF/data sizes. A file
+// whose data grows past 4 GiB is promoted to RF64 in place, using the JUNK
+// chunk reserved in the header for the ds64 sizes.
+class WavWriter
+{
+public:
+    WavWriter();
+    // Finalizes the file if it is still open
+    ~WavWriter();
+
+    WavWriter(const WavWriter &) = delete;
+    WavWriter &operator=(const WavWriter &) = delete;
+
+    bool open(const QString &filePath, const QAudioFormat &format, QString *errorString = nullptr);
+    bool append(const char *data, qint64 size);
+    bool append(const QByteArray &pcm);
+    // Writes the view page by page, without flattening it
+    bool append(const AudioView &view);
+    bool finalize(QString *errorString = nullptr);
+    // Closes and deletes a partially written file
+    void discard();
+
+    bool isOpen() const;
+    qint64 dataSize() const;
+    const QAudioFormat &format() const;
+
+private:
+    QFile m_file;
+    QAudioFormat m_format;
+    qint64 m_dataSize = 0;
+    bool m_failed = false;
+};
+
 bool readWavFile(const QString &filePath, QByteArray &pcmData, QAudioFormat &format, QString *errorString = nullptr);
 bool writeWavFile(const QString &filePath, const QAudioFormat &format, const QByteArray &pcmData, QString *errorString = nullptr);
+bool writeWavFile(const QString &filePath, const AudioView &view, QString *errorString = nullptr);
 
 }
@@ -0,0 +1,213 @@
+#include "audio/audiofiledecoder.h"
+#include "audio/audioproject.h"
+#include "audio/glueengine.h"
+#include "persistence/projectserializer.h"
+#include "utils/logger.h"
+#include "utils/pathutils.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QSet>
+#include <QTextStream>
+
+#include <algorithm>
+
+// Headless batch runner: decode -> split -> glue -> reverse for saved projects,
+// without QML or a display. Used for overnight rendering and for timing the
+// processing pipeline in isolation.
+
+namespace {
+
+struct BatchOptions
+{
+    QString outputDir;           // Empty: write next to each project.json
+    double noiseThreshold = 0.1; // Same default as the segment threshold in the app
+    bool decodeOriginal = true;
+};
+
+struct ProjectTimings
+{
+    qint64 decodeMs = 0;
+    qint64 splitMs = 0;
+    qint64 glueMs = 0;
+};
+
+// A path is either a project (.vups, project.json or a project directory) or a
+// directory searched recursively for projects. Each project is listed once.
+QStringList collectProjects(const QStringList &paths)
+{
+    QStringList projects;
+    QSet<QString> seen;
+    auto addProject = [&](const QString &path) {
+        const QString resolved = QFileInfo(ProjectSerializer::resolveProjectFile(path)).absoluteFilePath();
+        if (!seen.contains(resolved)) {
+            seen.insert(resolved);
+            projects.append(resolved);
+        }
+    };
+
+    for (const QString &path : paths) {
+        const QFileInfo info(path);
+        if (!info.isDir() || QFileInfo::exists(QDir(path).absoluteFilePath(QStringLiteral("project.json")))) {
+            addProject(path);
+            continue;
+        }
+        QStringList found;
+        QDirIterator it(path, {QStringLiteral("*.vups"), QStringLiteral("project.json")},
+                        QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext())
+            found.append(it.next());
+        std::sort(found.begin(), found.end());
+        for (const QString &file : found)
+            addProject(file);
+    }
+    return projects;
+}
+
+bool processProject(const QString &projectFile, const BatchOptions &options, AudioFileDecoder &decoder,
+                    GlueEngine &glue, ProjectTimings &timings, QString &projectName, QString *errorString)
+{
+    AudioProject project;
+    ProjectSerializer serializer;
+    if (!serializer.load(projectFile, project, errorString))
+        return false;
+
+    const QFileInfo projectInfo(projectFile);
+    projectName = project.projectName().isEmpty() ? projectInfo.dir().dirName() : project.projectName();
+
+    QElapsedTimer timer;
+    timer.start();
+    const QString originalPath = project.originalFilePath();
+    if (options.decodeOriginal && !originalPath.isEmpty() && QFileInfo::exists(originalPath)) {
+        if (!decoder.decodeFile(originalPath, project.originalBuffer(), errorString))
+            return false;
+    }
+    timings.decodeMs = timer.restart();
+
+    // Saved segments carry recordings and manual trims, so only a project
+    // without any segments is split from the decoded original
+    if (project.segments().isEmpty())
+        project.splitIntoSegments();
+    timings.splitMs = timer.restart();
+
+    const auto &segments = project.segments();
+    if (segments.isEmpty()) {
+        if (errorString)
+            *errorString = QStringLiteral("project has no segments");
+        return false;
+    }
+    for (const SegmentInfo &segment : segments) {
+        if (!segment.hasRecording || segment.recordingPath.isEmpty()) {
+            if (errorString)
+                *errorString = QStringLiteral("segment %1 is not recorded").arg(segment.displayIndex);
+            return false;
+        }
+    }
+
+    const QString outputDir = options.outputDir.isEmpty() ? projectInfo.absolutePath() : options.outputDir;
+    PathUtils::ensureDirectory(outputDir);
+    const QString songPath = PathUtils::composeFragmentSongFile(outputDir, projectName);
+    const QString reversePath = PathUtils::composeReverseFragmentSongFile(outputDir, projectName);
+    const bool glued = glue.glue(segments, options.noiseThreshold, songPath, reversePath, errorString);
+    timings.glueMs = timer.elapsed();
+    return glued;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setOrganizationName(QStringLiteral("VoiceUpsideDown"));
+    QCoreApplication::setOrganizationDomain(QStringLiteral("voiceupside.local"));
+    QCoreApplication::setApplicationName(QStringLiteral("Voice Upside Down CLI"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Glues the recorded segments of saved projects into the song and its reverse."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("paths"),
+                                 QStringLiteral(".vups files, project.json files or directories to search for projects."),
+                                 QStringLiteral("<path>..."));
+    const QCommandLineOption threadsOption({QStringLiteral("j"), QStringLiteral("threads")},
+                                           QStringLiteral("Worker threads for segment preparation (default: ideal thread count)."),
+                                           QStringLiteral("count"));
+    const QCommandLineOption outputOption({QStringLiteral("o"), QStringLiteral("output")},
+                                          QStringLiteral("Directory for the glued files (default: each project directory)."),
+                                          QStringLiteral("dir"));
+    const QCommandLineOption thresholdOption(QStringLiteral("noise-threshold"),
+                                             QStringLiteral("RMS level below which recording edges are trimmed (default: 0.1)."),
+                                             QStringLiteral("level"), QStringLiteral("0.1"));
+    const QCommandLineOption noDecodeOption(QStringLiteral("no-decode"),
+                                            QStringLiteral("Skip decoding the original audio of each project."));
+    const QCommandLineOption quietOption({QStringLiteral("q"), QStringLiteral("quiet")},
+                                         QStringLiteral("Suppress informational log output."));
+    parser.addOptions({threadsOption, outputOption, thresholdOption, noDecodeOption, quietOption});
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (parser.positionalArguments().isEmpty()) {
+        err << "No projects given\n";
+        parser.showHelp(2);
+    }
+    if (parser.isSet(quietOption))
+        QLoggingCategory::setFilterRules(QStringLiteral("*.info=false\n*.debug=false"));
+
+    BatchOptions options;
+    options.outputDir = parser.value(outputOption);
+    options.decodeOriginal = !parser.isSet(noDecodeOption);
+    bool ok = false;
+    options.noiseThreshold = parser.value(thresholdOption).toDouble(&ok);
+    if (!ok || options.noiseThreshold < 0.0 || options.noiseThreshold > 1.0) {
+        err << "Invalid noise threshold: " << parser.value(thresholdOption) << "\n";
+        return 2;
+    }
+
+    GlueEngine glue;
+    if (parser.isSet(threadsOption)) {
+        const int threads = parser.value(threadsOption).toInt(&ok);
+        if (!ok || threads <= 0) {
+            err << "Invalid thread count: " << parser.value(threadsOption) << "\n";
+            return 2;
+        }
+        glue.setMaxThreadCount(threads);
+    }
+
+    const QStringList projects = collectProjects(parser.positionalArguments());
+    if (projects.isEmpty()) {
+        err << "No projects found\n";
+        return 1;
+    }
+
+    AudioFileDecoder decoder;
+    int failed = 0;
+    QElapsedTimer total;
+    total.start();
+    for (const QString &projectFile : projects) {
+        ProjectTimings timings;
+        QString projectName = QFileInfo(projectFile).completeBaseName();
+        QString error;
+        if (processProject(projectFile, options, decoder, glue, timings, projectName, &error)) {
+            out << "ok    " << projectName
+                << "  decode " << timings.decodeMs << " ms"
+                << "  split " << timings.splitMs << " ms"
+                << "  glue " << timings.glueMs << " ms\n";
+        } else {
+            ++failed;
+            out << "FAIL  " << projectName << "  " << projectFile << ": " << error << "\n";
+        }
+        out.flush();
+    }
+
+    out << projects.size() - failed << "/" << projects.size() << " projects processed in "
+        << total.elapsed() << " ms with " << glue.maxThreadCount() << " threads\n";
+    return failed == 0 ? 0 : 1;
+}
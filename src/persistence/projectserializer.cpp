@@ -205,3 +205,23 @@ bool ProjectSerializer::load(const QString &projectFilePath, AudioProject &proje
     return true;
 }
 
+
+QString ProjectSerializer::resolveProjectFile(const QString &path)
+{
+    const QFileInfo fileInfo(path);
+    if (fileInfo.isDir())
+        return QDir(fileInfo.absoluteFilePath()).absoluteFilePath(QStringLiteral("project.json"));
+
+    if (fileInfo.suffix().toLower() == QStringLiteral("vups")) {
+        // .vups file points to the project directory of the same name
+        const QString projectDir = fileInfo.absolutePath() + QDir::separator() + fileInfo.completeBaseName();
+        const QString projectJsonPath = projectDir + QDir::separator() + QStringLiteral("project.json");
+        if (QFileInfo::exists(projectJsonPath)) {
+            LOG_INFO() << "Found project.json at" << projectJsonPath;
+            return projectJsonPath;
+        }
+        // The .vups file may contain the project data itself
+        LOG_INFO() << "Using .vups file directly as project file";
+    }
+    return path;
+}
@@ -13,5 +13,9 @@ public:
 
     bool save(const QString &directoryPath, const AudioProject &project, QString *errorString = nullptr);
     bool load(const QString &projectFilePath, AudioProject &project, QString *errorString = nullptr);
+
+    // Maps a .vups file to the project.json in its project directory (when present)
+    // and a project directory to its project.json; other paths are returned as is
+    static QString resolveProjectFile(const QString &path);
 };
 
@@ -79,5 +79,15 @@ QString composeReverseSongFile(const QString &baseDir, const QString &songName)
     return ensureTrailingSlash(baseDir) + QStringLiteral("reverse_%1.wav").arg(songName);
 }
 
+QString composeFragmentSongFile(const QString &projectDir, const QString &projectName)
+{
+    return ensureTrailingSlash(projectDir) + QStringLiteral("%1_fragment_song.wav").arg(projectName);
+}
+
+QString composeReverseFragmentSongFile(const QString &projectDir, const QString &projectName)
+{
+    return ensureTrailingSlash(projectDir) + QStringLiteral("%1_revers_fragment_song.wav").arg(projectName);
+}
+
 }
 
@@ -16,6 +16,9 @@ QString composeSegmentFile(const QString &baseDir, int segmentIndex);
 QString composeSegmentReverseFile(const QString &baseDir, int segmentIndex);
 QString composeSongFile(const QString &baseDir, const QString &songName);
 QString composeReverseSongFile(const QString &baseDir, const QString &songName);
+// Glued results stored inside a project directory, picked up when the project is opened
+QString composeFragmentSongFile(const QString &projectDir, const QString &projectName);
+QString composeReverseFragmentSongFile(const QString &projectDir, const QString &projectName);
 
 }
 